@@ -1,3 +1,5 @@
+#ifndef PRESSIO_SEARCH_H
+#define PRESSIO_SEARCH_H
 #include <stdexcept>
 #include <functional>
 #include <libpressio_ext/cpp/pressio.h>
@@ -55,6 +57,13 @@ struct pressio_search_plugin : public pressio_versionable, public pressio_config
                                                   pressio_search_results::input_type const &)> compress_fn,
                                           distributed::queue::StopToken &stop_token) =0;
 
+    /**
+     * \returns metrics collected by the search plugin during the last search
+     */
+    virtual pressio_options get_metrics_results() const {
+      return {};
+    }
+
     /**
      * \returns a clone of the current search object
      */
@@ -113,3 +122,5 @@ struct pressio_search {
 
 /** \returns a reference to the registry singleton */
 pressio_registry<std::shared_ptr<pressio_search_plugin>>& search_plugins();
+
+#endif /* end of include guard: PRESSIO_SEARCH_H */
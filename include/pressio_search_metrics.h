@@ -47,6 +47,14 @@ struct pressio_search_metrics_plugin : public pressio_configurable{
    * \param[in] out the input to this iteration
    */
   virtual void end_iter(pressio_search_results::input_type const& inputs, pressio_search_results::output_type const& out){ (void)inputs; (void)out;}
+  /**
+   * called instead of begin_iter and end_iter for an input that was not evaluated because
+   * opt:screen predicted that it could not improve on the best configuration
+   *
+   * \param[in] inputs the input that was screened
+   * \param[in] predicted the outputs predicted by the screen
+   */
+  virtual void screened_iter(pressio_search_results::input_type const& inputs, pressio_search_results::output_type const& predicted){ (void)inputs; (void)predicted;}
   /**
    * called at the beginning the entire search
    */
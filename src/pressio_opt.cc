@@ -3,6 +3,8 @@
 #include <iterator>
 #include <mutex>
 #include <condition_variable>
+#include <cmath>
+#include <limits>
 #include <mpi.h>
 #include "pressio_compressor.h"
 #include "libpressio_ext/cpp/pressio.h"
@@ -14,6 +16,10 @@
 #include "pressio_search.h"
 #include "pressio_search_metrics.h"
 #include "pressio_search_defines.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_warm_start.h"
 #include "libpressio_opt_version.h"
 #include <std_compat/memory.h>
 
@@ -30,16 +36,25 @@ namespace {
     return names;
 }
 
+//the pseudo-input that selects one of opt:compressors
+const std::string compressor_index_setting = "opt:compressor_index";
+
 class OptStopToken: public distributed::queue::StopToken {
+  public:
+  OptStopToken()=default;
+  explicit OptStopToken(pressio_search_budget const& budget): budget(budget) {}
+
   bool stop_requested() {
-    return should_stop;
+    return should_stop || budget.expired();
   }
 
   void request_stop() {
     should_stop = true;
   }
 
+  private:
   bool should_stop = false;
+  pressio_search_budget budget;
 };
 }
 
@@ -63,6 +78,18 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
       set(options, "opt:output", "list of output settings");
       set(options, "opt:do_decompress", "preform decompression while tuning");
       set(options, "opt:prediction", "guess of the optimal configuration");
+      set(options, "opt:target", "the target value; if a list of targets is provided, each is searched for using a shared pool of evaluations");
+      set(options, "opt:time_budget", "the wall-clock seconds available for the entire search; nested searches receive their share of the remaining budget");
+      set(options, "opt:constraints", "constraints on the outputs of the form <output> >= <value> or <output> <= <value>");
+      set(options, "opt:constraints_monotone", "for each input, +1 if increasing it can only make the constraints more violated, -1 if decreasing it can, 0 if unknown");
+      set(options, "opt:transform", "for each input, the space it is searched in: linear, log10, or logit");
+      set(options, "opt:compressors", "ids of candidate compressors; the input opt:compressor_index selects which one is configured by the other inputs");
+      set(options, "opt:screen", "id of a cheap proxy compressor run before each evaluation; candidates it predicts cannot beat the incumbent are not evaluated");
+      set(options, "opt:screen_outputs", "the metrics of the proxy compressor that predict opt:output, opt:output by default");
+      set(options, "opt:warm_start", "1 if searches should start from past searches on similar data");
+      set(options, "opt:warm_start_path", "file where past searches are saved between runs, if empty they are only kept in memory");
+      set(options, "opt:warm_start_neighbors", "the number of the most similar past searches to start from");
+      set(options, "opt:screen_margin", "how much worse than the incumbent, relative to the incumbent's objective or the target, a prediction must be to skip the evaluation");
       return options;
     }
     struct pressio_options get_options_impl() const override {
@@ -74,6 +101,19 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
       set(options, "opt:inputs", input_settings);
       set(options, "opt:output", output_settings);
       set(options, "opt:do_decompress", do_decompress);
+      if(targets.size() > 1) {
+        set(options, "opt:target", pressio_data(std::begin(targets), std::end(targets)));
+      }
+      set(options, "opt:time_budget", time_budget);
+      set(options, "opt:constraints", constraints.constraints());
+      set(options, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(options, "opt:compressors", compressor_methods);
+      set(options, "opt:screen", screen_method);
+      set(options, "opt:screen_outputs", screen_outputs);
+      set(options, "opt:screen_margin", screen_margin);
+      set(options, "opt:warm_start", warm_start);
+      set(options, "opt:warm_start_path", warm_start_path);
+      set(options, "opt:warm_start_neighbors", warm_start_neighbors);
       return options;
     }
 
@@ -88,6 +128,19 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
 
     int set_options_impl(struct pressio_options const& options) override {
       pressio_options search_options = options;
+      pressio_data data;
+      pressio_search_results::output_type::value_type single_target;
+      if(get(search_options, "opt:target", &single_target) == pressio_options_key_set) {
+        targets.clear();
+        target = single_target;
+      } else if(get(search_options, "opt:target", &data) == pressio_options_key_set) {
+        //the searchers only understand a single target, give them the first one
+        targets = data.to_vector<pressio_search_results::output_type::value_type>();
+        if(not targets.empty()) {
+          search_options.set("opt:target", targets.front());
+          target = targets.front();
+        }
+      }
       std::string mode_name;
       if(get(search_options, "opt:objective_mode_name", &mode_name) == pressio_options_key_set) {
         unsigned int mode = 0;
@@ -97,10 +150,57 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
         else if(mode_name == "none") mode = pressio_search_mode_none;
 
         search_options.set(search->get_name(), "opt:objective_mode", mode);
+        objective_mode = mode;
         search_options.set_type(search->get_name(), "opt:objective_mode_name", pressio_option_charptr_type);
       }
 
       get_meta(search_options, "opt:compressor", compressor_plugins(), compressor_method, compressor);
+      std::vector<std::string> new_compressor_methods;
+      if(get(search_options, "opt:compressors", &new_compressor_methods) == pressio_options_key_set &&
+          new_compressor_methods != compressor_methods) {
+        //candidates are built once here and reused for every evaluation
+        std::vector<pressio_compressor> new_candidates;
+        for (auto const& method : new_compressor_methods) {
+          auto candidate = library.get_compressor(method);
+          if(not candidate) {
+            return set_error(5, "failed to build compressor " + method + ": " + library.err_msg());
+          }
+          candidate->set_name(get_name() + "/" + candidate->prefix());
+          new_candidates.emplace_back(std::move(candidate));
+        }
+        compressor_methods = std::move(new_compressor_methods);
+        candidates = std::move(new_candidates);
+        selected_compressor = 0;
+      }
+      for (auto& candidate : candidates) {
+        candidate->set_options(search_options);
+      }
+      get(search_options, "opt:objective_mode", &objective_mode);
+      std::string new_screen_method;
+      if(get(search_options, "opt:screen", &new_screen_method) == pressio_options_key_set &&
+          new_screen_method != screen_method) {
+        pressio_compressor new_screen;
+        if(not new_screen_method.empty()) {
+          new_screen = library.get_compressor(new_screen_method);
+          if(not new_screen) {
+            return set_error(5, "failed to build compressor " + new_screen_method + ": " + library.err_msg());
+          }
+          new_screen->set_name(get_name() + "/" + new_screen->prefix());
+        }
+        screen_method = std::move(new_screen_method);
+        screen = std::move(new_screen);
+      }
+      if(screen) {
+        screen->set_options(search_options);
+      }
+      get(search_options, "opt:screen_outputs", &screen_outputs);
+      get(search_options, "opt:screen_margin", &screen_margin);
+      get(search_options, "opt:warm_start", &warm_start);
+      get(search_options, "opt:warm_start_path", &warm_start_path);
+      get(search_options, "opt:warm_start_neighbors", &warm_start_neighbors);
+      if(get(search_options, "opt:prediction", &data) == pressio_options_key_set) {
+        prediction = data.to_vector<pressio_search_results::input_element_type>();
+      }
       //the search needs to know if the compressor is thread_safe, and can only
       //check if that is true, after the compressor has been configured
       search_options.set("opt:thread_safe", is_thread_safe());
@@ -108,11 +208,37 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
       get_meta(search_options, "opt:search", search_plugins(), search_method, search);
       get_meta(search_options, "opt:search_metrics", search_metrics_plugins(), search_metrics_method, search_metrics);
       get(search_options, "opt:inputs", &input_settings);
+      //inputs may only apply to some of the candidates, but must apply to at least one
+      if(not candidates.empty()) {
+        std::vector<pressio_options> candidate_options;
+        for (auto const& candidate : candidates) {
+          candidate_options.emplace_back(candidate->get_options());
+        }
+        for (auto const& input : input_settings) {
+          if(input == compressor_index_setting) continue;
+          if(std::none_of(std::begin(candidate_options), std::end(candidate_options), [&input](pressio_options const& options) {
+                return options.key_status(input) != pressio_options_key_does_not_exist;
+              })) {
+            return set_error(1, "setting does not exist in any of opt:compressors: " + input);
+          }
+        }
+      }
       get(search_options, "opt:output", &output_settings);
       get(search_options, "opt:do_decompress", &do_decompress);
+      get(search_options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      if(get(search_options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(search_options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      get(search_options, "opt:evaluations", &evaluations_data);
+      get(search_options, "opt:time_budget", &time_budget);
+      std::string constraints_err;
+      if(constraints.set_options(search_options, get_name(), constraints_err)) {
+        return set_error(4, constraints_err);
+      }
 
-
-      
       return 0;
     }
 
@@ -127,103 +253,52 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
       auto common_compress_thread_fn = [&run_search_metrics, &input_datas,
                                  this](pressio_search_results::input_type const&
                                          input_v, pressio_compressor& thread_compressor, compat::span<pressio_data*>& thread_outputs) {
-        if (run_search_metrics)
-          search_metrics->begin_iter(input_v);
-
         if(input_v.size() != input_settings.size()) {
             throw pressio_search_exception(
               std::string("mismatched number of inputs inputs=") + std::to_string(input_v.size()) + " settings=" + std::to_string(input_settings.size()));
         }
 
-        //configure the compressor for this input
-        auto base = thread_compressor->get_options();
-        pressio_options settings;
-        for (size_t i = 0; i < input_v.size(); ++i) {
-          if(base.key_status(input_settings[i]) == pressio_options_key_does_not_exist) {
-            throw pressio_search_exception(
-              std::string("setting does not exist: ") + input_settings[i]);
-          }
-          settings.set(input_settings[i], base.get(input_settings[i]));
-          switch(settings.cast_set(input_settings[i], input_v[i], pressio_conversion_explicit)) {
-            case pressio_options_key_does_not_exist:
-              throw pressio_search_exception("setting does not exist: " + input_settings[i]);
-            case pressio_options_key_exists:
-              throw pressio_search_exception("failed to convert setting: " + input_settings[i]);
-            default:
-              break;
+        if (run_search_metrics && screen) {
+          //answer candidates that clearly cannot beat the incumbent with the proxy's prediction,
+          //these are not evaluations so they are reported to the search metrics separately
+          auto predicted = screen_candidate(input_v, input_datas, thread_outputs);
+          if(predicted) {
+            search_metrics->screened_iter(input_v, *predicted);
+            return *predicted;
           }
         }
-        if(thread_compressor->set_options(settings)) {
-          throw pressio_search_exception(
-            std::string("failed to configure compressor: ") +
-            thread_compressor->error_msg());
-        }
 
-        pressio_data decompressed;
-        if(thread_compressor->compress_many(
-              input_datas.data(),
-              input_datas.data()+input_datas.size(),
-              thread_outputs.data(),
-              thread_outputs.data()+thread_outputs.size())) {
-          throw pressio_search_exception(
-            std::string("failed to compress data: ") +
-            thread_compressor->error_msg());
-        }
-
-        if(do_decompress) {
-          std::vector<pressio_data> decompressed;
-          std::vector<pressio_data*> decompressed_ptrs;
-          std::transform(
-              std::begin(input_datas),
-              std::end(input_datas),
-              std::back_inserter(decompressed),
-              [](const pressio_data * input_data) {
-                return pressio_data::owning(input_data->dtype(), input_data->dimensions());
-              });
-          std::transform(
-              std::begin(decompressed),
-              std::end(decompressed),
-              std::back_inserter(decompressed_ptrs),
-              [](pressio_data& decompressed) {
-                return &decompressed;
-              });
-          if(thread_compressor->decompress_many(
-                thread_outputs.data(),
-                thread_outputs.data()+thread_outputs.size(),
-                decompressed_ptrs.data(),
-                decompressed_ptrs.data()+decompressed_ptrs.size())) {
-            throw pressio_search_exception(
-              std::string("failed to decompress data: ") +
-              thread_compressor->error_msg());
-          }
-        }
-
-        auto metrics_results = thread_compressor->get_metrics_results();
+        if (run_search_metrics)
+          search_metrics->begin_iter(input_v);
 
-        std::vector<double> results;
-        for (auto const& output_setting : output_settings) {
-          double result;
-          if(metrics_results.find(output_setting) == metrics_results.end()) {
-            throw pressio_search_exception(
-              std::string("metric does not exist: ") + output_setting);
+        auto results = evaluate_compressor(thread_compressor, input_v, input_datas, thread_outputs, output_settings);
+
+        if (run_search_metrics) {
+          {
+            std::lock_guard<std::mutex> guard(history_mutex);
+            history.emplace(input_v, results);
+            if(constraints.feasible(results)) {
+              const double result_loss = objective_loss(results.front());
+              if(not incumbent_loss || result_loss < *incumbent_loss) {
+                incumbent_loss = result_loss;
+                incumbent_value = results.front();
+              }
+            }
+            ++screen_evaluated;
           }
-          if(metrics_results.cast(output_setting, &result, pressio_conversion_explicit) != pressio_options_key_set) {
-            throw pressio_search_exception(
-              std::string("metric is not convertible to double: ") +
-              output_setting);
+          if(not constraints.empty()) {
+            std::lock_guard<std::mutex> guard(feasibility_mutex);
+            feasibility.push_back(constraints.feasible(results));
           }
-          results.push_back(result);
-        }
-
-        if (run_search_metrics)
           search_metrics->end_iter(input_v, results);
+        }
         return results;
       };
 
       auto compress_thread_fn = [&outputs, &common_compress_thread_fn,
                                  this](pressio_search_results::input_type const&
                                          input_v) {
-        pressio_compressor thread_compressor = compressor->clone();
+        pressio_compressor thread_compressor = compressor_for(input_v)->clone();
         std::vector<pressio_data> thread_outputs;
         std::vector<pressio_data*> thread_outputs_ptrs;
         std::transform(std::begin(outputs), std::end(outputs), std::back_inserter(thread_outputs),
@@ -240,13 +315,45 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
 
       auto compress_fn = [&outputs, &common_compress_thread_fn, this](
                            pressio_search_results::input_type const& input_v) {
-        return common_compress_thread_fn(input_v, compressor, outputs);
+        selected_compressor = compressor_index(input_v);
+        return common_compress_thread_fn(input_v, active_compressor(), outputs);
       };
 
       try {
-        OptStopToken token;
+        pressio_search_budget budget(time_budget);
+        OptStopToken token(budget);
         search_metrics->begin_search();
-        last_results = search->search(input_datas, compress_thread_fn, token);
+        feasibility.clear();
+        history.clear();
+        incumbent_loss.reset();
+        incumbent_value.reset();
+        screen_skipped = 0;
+        screen_evaluated = 0;
+        warm_start_used = 0;
+        warm_start_evaluations = 0;
+        pressio_search_features features;
+        if(warm_start) {
+          features = pressio_search_features::compute(input_datas);
+        }
+        if(targets.size() > 1) {
+          last_results = multi_target_search(input_datas, compress_thread_fn, budget);
+        } else {
+          target_results.clear();
+          std::unique_ptr<pressio_search_options_guard> restore;
+          if(warm_start) {
+            restore = compat::make_unique<pressio_search_options_guard>(search);
+            apply_warm_start(features, compress_thread_fn, budget);
+          }
+          last_results = search->search(input_datas, compress_thread_fn, token);
+        }
+        if(warm_start && not history.empty()) {
+          //only the objective is kept, so infeasible evaluations could not be told apart later
+          std::string warm_start_err;
+          if(pressio_search_warm_start::library(warm_start_path)->add(
+                {warm_start_key(features), features.values, feasible_evaluations(history)}, warm_start_err)) {
+            return set_error(6, warm_start_err);
+          }
+        }
         search_metrics->end_search(last_results->inputs, last_results->output);
         //set metrics results to the results metrics
         run_search_metrics = false;
@@ -273,7 +380,7 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
       return decompress_many_impl(inputs, outputs);
     }
     int decompress_many_impl(const compat::span<pressio_data const*const>& inputs, compat::span<struct pressio_data*>& outputs) override {
-      return compressor->decompress_many(
+      return active_compressor()->decompress_many(
           inputs.data(),
           inputs.data()+inputs.size(),
           outputs.data(),
@@ -308,6 +415,12 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
 
     void set_name_impl(std::string const& new_name) override {
       compressor->set_name(new_name + "/" + compressor->prefix());
+      for (auto& candidate : candidates) {
+        candidate->set_name(new_name + "/" + candidate->prefix());
+      }
+      if(screen) {
+        screen->set_name(new_name + "/" + screen->prefix());
+      }
       search->set_name(new_name + "/" + search->prefix());
       search_metrics->set_name(new_name + "/" + search_metrics->prefix());
     }
@@ -318,6 +431,23 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
 
       tmp->compressor = compressor->clone();
       tmp->compressor_method = compressor_method;
+      for (auto const& candidate : candidates) {
+        tmp->candidates.emplace_back(candidate->clone());
+      }
+      tmp->compressor_methods = compressor_methods;
+      tmp->selected_compressor = selected_compressor;
+      if(screen) {
+        tmp->screen = screen->clone();
+      }
+      tmp->screen_method = screen_method;
+      tmp->screen_outputs = screen_outputs;
+      tmp->screen_margin = screen_margin;
+      tmp->objective_mode = objective_mode;
+      tmp->warm_start = warm_start;
+      tmp->warm_start_path = warm_start_path;
+      tmp->warm_start_neighbors = warm_start_neighbors;
+      tmp->prediction = prediction;
+      tmp->target = target;
 
       tmp->search = search->clone();
       tmp->search_method = search_method;
@@ -327,11 +457,19 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
       tmp->input_settings = input_settings;
       tmp->output_settings = output_settings;
       tmp->do_decompress = do_decompress;
+      tmp->targets = targets;
+      tmp->global_rel_tolerance = global_rel_tolerance;
+      tmp->lower_bound = lower_bound;
+      tmp->upper_bound = upper_bound;
+      tmp->evaluations_data = evaluations_data;
+      tmp->time_budget = time_budget;
+      tmp->constraints = constraints;
       return tmp;
     }
 
     pressio_options get_metrics_results_impl() const override {
       auto search_metrics_results = search_metrics->get_metrics_results();
+      search_metrics_results.copy_from(search->get_metrics_results());
       if(last_results) {
         set(search_metrics_results, "opt:input", pressio_data(std::begin(last_results->inputs), std::end(last_results->inputs)));
         set(search_metrics_results, "opt:output", pressio_data(std::begin(last_results->output), std::end(last_results->output)));
@@ -343,16 +481,446 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
         set_type(search_metrics_results, "opt:msg", pressio_option_charptr_type);
         set_type(search_metrics_results, "opt:status", pressio_option_int32_type);
       }
+      set(search_metrics_results, "opt:evaluations", history_to_evaluations(history, input_settings.size(), evaluations_data));
+      if(not candidates.empty()) {
+        set(search_metrics_results, "opt:selected_compressor", compressor_methods[selected_compressor]);
+      } else {
+        set_type(search_metrics_results, "opt:selected_compressor", pressio_option_charptr_type);
+      }
+      if(warm_start) {
+        set(search_metrics_results, "opt:warm_start_neighbors", warm_start_used);
+        set(search_metrics_results, "opt:warm_start_evaluations", warm_start_evaluations);
+      } else {
+        set_type(search_metrics_results, "opt:warm_start_neighbors", pressio_option_uint64_type);
+        set_type(search_metrics_results, "opt:warm_start_evaluations", pressio_option_uint64_type);
+      }
+      if(screen) {
+        set(search_metrics_results, "opt:screen_skipped", screen_skipped);
+        set(search_metrics_results, "opt:screen_evaluated", screen_evaluated);
+      } else {
+        set_type(search_metrics_results, "opt:screen_skipped", pressio_option_uint64_type);
+        set_type(search_metrics_results, "opt:screen_evaluated", pressio_option_uint64_type);
+      }
+      if(not constraints.empty()) {
+        set(search_metrics_results, "opt:feasible", pressio_data(std::begin(feasibility), std::end(feasibility)));
+        set(search_metrics_results, "opt:n_feasible", static_cast<uint64_t>(std::count(std::begin(feasibility), std::end(feasibility), 1)));
+        set(search_metrics_results, "opt:n_infeasible", static_cast<uint64_t>(std::count(std::begin(feasibility), std::end(feasibility), 0)));
+      }
+      if(not target_results.empty()) {
+        set(search_metrics_results, "opt:target_inputs", results_to_data(target_results, &pressio_search_results::inputs));
+        set(search_metrics_results, "opt:target_outputs", results_to_data(target_results, &pressio_search_results::output));
+        std::vector<int32_t> status;
+        std::transform(std::begin(target_results), std::end(target_results), std::back_inserter(status),
+            [](pressio_search_results const& result) { return result.status; });
+        set(search_metrics_results, "opt:target_status", pressio_data(std::begin(status), std::end(status)));
+      } else {
+        set_type(search_metrics_results, "opt:target_inputs", pressio_option_data_type);
+        set_type(search_metrics_results, "opt:target_outputs", pressio_option_data_type);
+        set_type(search_metrics_results, "opt:target_status", pressio_option_data_type);
+      }
       return search_metrics_results;
     }
 
 
   private:
+    /**
+     * searches for each of the targets in turn sharing a single pool of evaluations
+     *
+     * targets that are already within tolerance of a feasible evaluation are
+     * answered from the pool, and for single input searches the remaining
+     * targets are searched only within the tightest bracket of feasible evaluations
+     */
+    pressio_search_results multi_target_search(compat::span<const pressio_data *const> const &input_datas,
+        std::function<pressio_search_results::output_type(pressio_search_results::input_type const&)> const& compress_fn,
+        pressio_search_budget const& budget) {
+      //the bounds the searcher was configured with apply to every target without a bracket
+      pressio_search_options_guard restore(search);
+      pressio_data original_lower, original_upper;
+      restore.options().get(search->get_name(), "opt:lower_bound", &original_lower);
+      restore.options().get(search->get_name(), "opt:upper_bound", &original_upper);
+
+      pressio_search_cache cache(compress_fn);
+      auto shared_compress_fn = [&cache](pressio_search_results::input_type const& input) {
+        return cache(input);
+      };
+
+      target_results.clear();
+      for (size_t target_idx = 0; target_idx < targets.size(); ++target_idx) {
+        auto const& target = targets[target_idx];
+        auto const all_evaluations = cache.history();
+        auto const history = feasible_evaluations(all_evaluations);
+        auto answer = std::min_element(std::begin(history), std::end(history),
+            [target](pressio_search_history::value_type const& lhs, pressio_search_history::value_type const& rhs) {
+              return std::abs(lhs.second.front() - target) < std::abs(rhs.second.front() - target);
+            });
+        if(answer != std::end(history) &&
+            std::abs(answer->second.front() - target) <= std::abs(target * global_rel_tolerance)) {
+          pressio_search_results result;
+          result.inputs = answer->first;
+          result.output = answer->second;
+          target_results.emplace_back(std::move(result));
+          continue;
+        }
+
+        pressio_options target_options;
+        target_options.set("opt:target", target);
+        auto bracket = find_bracket(history, target);
+        if(bracket) {
+          target_options.set("opt:lower_bound", pressio_data{bracket->first});
+          target_options.set("opt:upper_bound", pressio_data{bracket->second});
+        } else {
+          target_options.set("opt:lower_bound", original_lower);
+          target_options.set("opt:upper_bound", original_upper);
+        }
+        target_options.set("opt:evaluations", seed_evaluations(all_evaluations, constraints, input_settings.size(), evaluations_data));
+        target_options.set("opt:time_budget", budget.share(targets.size() - target_idx));
+        search->set_options(target_options);
+
+        OptStopToken token(budget);
+        target_results.emplace_back(search->search(input_datas, shared_compress_fn, token));
+      }
+
+      //the compressed output is produced using the configuration for the first target
+      auto results = target_results.front();
+      //report the worst status: errors before warnings such as exceeded limits before success
+      auto severity = [](int status) { return (status > 0) ? 2 : ((status < 0) ? 1 : 0); };
+      auto failed = std::max_element(std::begin(target_results), std::end(target_results),
+          [&severity](pressio_search_results const& lhs, pressio_search_results const& rhs) {
+            return severity(lhs.status) < severity(rhs.status);
+          });
+      if(failed->status != 0) {
+        results.status = failed->status;
+        results.msg = "target " + std::to_string(targets[std::distance(std::begin(target_results), failed)]) + " failed: " + failed->msg;
+      }
+      return results;
+    }
+
+    /**
+     * \returns the evaluations in history that succeeded and satisfy opt:constraints
+     */
+    pressio_search_history feasible_evaluations(pressio_search_history history) const {
+      for (auto it = std::begin(history); it != std::end(history);) {
+        if(it->second.empty() || !constraints.feasible(it->second)) it = history.erase(it);
+        else ++it;
+      }
+      return history;
+    }
+
+    /**
+     * \returns the narrowest pair of adjacent evaluations whose objectives
+     * straddle the target, only defined for single input searches
+     */
+    compat::optional<std::pair<double,double>> find_bracket(pressio_search_history const& history, double target) const {
+      compat::optional<std::pair<double,double>> bracket;
+      if(input_settings.size() != 1 || history.size() < 2) return bracket;
+      //history is ordered by the input so adjacent entries are neighbors
+      for (auto lower = std::begin(history), upper = std::next(lower); upper != std::end(history); ++lower, ++upper) {
+        if((lower->second.front() - target) * (upper->second.front() - target) > 0) continue;
+        auto width = upper->first.front() - lower->first.front();
+        if(not bracket || width < (bracket->second - bracket->first)) {
+          bracket = std::make_pair(lower->first.front(), upper->first.front());
+        }
+      }
+      return bracket;
+    }
+
+    /**
+     * \returns a 2d pressio_data with one row per result from the provided field
+     */
+    static pressio_data results_to_data(std::vector<pressio_search_results> const& results,
+        std::vector<double> pressio_search_results::* field) {
+      size_t width = 0;
+      for (auto const& result : results) {
+        width = std::max(width, (result.*field).size());
+      }
+      std::vector<double> values(width * results.size(), std::numeric_limits<double>::quiet_NaN());
+      for (size_t i = 0; i < results.size(); ++i) {
+        std::copy(std::begin(results[i].*field), std::end(results[i].*field), std::begin(values) + i*width);
+      }
+      auto data = pressio_data(std::begin(values), std::end(values));
+      data.reshape({width, results.size()});
+      return data;
+    }
+
+    /**
+     * configures the compressor with the input, compresses the data, and reads the metrics in names
+     */
+    std::vector<double> evaluate_compressor(pressio_compressor& thread_compressor,
+        pressio_search_results::input_type const& input_v,
+        compat::span<const pressio_data* const> const& input_datas,
+        compat::span<pressio_data*>& thread_outputs,
+        std::vector<std::string> const& names) const {
+      //configure the compressor for this input
+      auto base = thread_compressor->get_options();
+      pressio_options settings;
+      for (size_t i = 0; i < input_v.size(); ++i) {
+        if(input_settings[i] == compressor_index_setting) continue;
+        if(base.key_status(input_settings[i]) == pressio_options_key_does_not_exist) {
+          //inputs may only apply to some of the candidate compressors
+          if(not candidates.empty()) continue;
+          throw pressio_search_exception(
+            std::string("setting does not exist: ") + input_settings[i]);
+        }
+        settings.set(input_settings[i], base.get(input_settings[i]));
+        switch(settings.cast_set(input_settings[i], input_v[i], pressio_conversion_explicit)) {
+          case pressio_options_key_does_not_exist:
+            throw pressio_search_exception("setting does not exist: " + input_settings[i]);
+          case pressio_options_key_exists:
+            throw pressio_search_exception("failed to convert setting: " + input_settings[i]);
+          default:
+            break;
+        }
+      }
+      if(thread_compressor->set_options(settings)) {
+        throw pressio_search_exception(
+          std::string("failed to configure compressor: ") +
+          thread_compressor->error_msg());
+      }
+
+      pressio_data decompressed;
+      if(thread_compressor->compress_many(
+            input_datas.data(),
+            input_datas.data()+input_datas.size(),
+            thread_outputs.data(),
+            thread_outputs.data()+thread_outputs.size())) {
+        throw pressio_search_exception(
+          std::string("failed to compress data: ") +
+          thread_compressor->error_msg());
+      }
+
+      if(do_decompress) {
+        std::vector<pressio_data> decompressed;
+        std::vector<pressio_data*> decompressed_ptrs;
+        std::transform(
+            std::begin(input_datas),
+            std::end(input_datas),
+            std::back_inserter(decompressed),
+            [](const pressio_data * input_data) {
+              return pressio_data::owning(input_data->dtype(), input_data->dimensions());
+            });
+        std::transform(
+            std::begin(decompressed),
+            std::end(decompressed),
+            std::back_inserter(decompressed_ptrs),
+            [](pressio_data& decompressed) {
+              return &decompressed;
+            });
+        if(thread_compressor->decompress_many(
+              thread_outputs.data(),
+              thread_outputs.data()+thread_outputs.size(),
+              decompressed_ptrs.data(),
+              decompressed_ptrs.data()+decompressed_ptrs.size())) {
+          throw pressio_search_exception(
+            std::string("failed to decompress data: ") +
+            thread_compressor->error_msg());
+        }
+      }
+
+      auto metrics_results = thread_compressor->get_metrics_results();
+
+      std::vector<double> results;
+      for (auto const& output_setting : names) {
+        double result;
+        if(metrics_results.find(output_setting) == metrics_results.end()) {
+          throw pressio_search_exception(
+            std::string("metric does not exist: ") + output_setting);
+        }
+        if(metrics_results.cast(output_setting, &result, pressio_conversion_explicit) != pressio_options_key_set) {
+          throw pressio_search_exception(
+            std::string("metric is not convertible to double: ") +
+            output_setting);
+        }
+        results.push_back(result);
+      }
+      return results;
+    }
+
+    /**
+     * \returns the key of past searches that can warm start this one
+     */
+    std::string warm_start_key(pressio_search_features const& features) const {
+      std::ostringstream key;
+      if(candidates.empty()) {
+        key << compressor_method;
+      } else {
+        for (auto const& method : compressor_methods) key << method << ',';
+      }
+      key << '|';
+      for (auto const& input : input_settings) key << input << ',';
+      key << '|' << output_settings.front() << '|' << features.key;
+      return key.str();
+    }
+
+    /**
+     * configures the search to start from the past searches on the data most similar to this data
+     *
+     * the past evaluations are of other data, so they cannot end the search; instead the best point of
+     * each of the nearest searches is evaluated on this data and passed to the search as `opt:evaluations`.
+     * For single input searches for a target, the bounds are first narrowed to the evaluations on either
+     * side of those that bracket the target.
+     *
+     * the caller restores the options of the search afterwards
+     */
+    void apply_warm_start(pressio_search_features const& features,
+        std::function<pressio_search_results::output_type(pressio_search_results::input_type const&)> const& compress_fn,
+        pressio_search_budget const& budget) {
+      auto const neighbors = pressio_search_warm_start::library(warm_start_path)->nearest(
+          warm_start_key(features), features.values, warm_start_neighbors);
+      warm_start_used = neighbors.size();
+      pressio_search_history prior;
+      for (auto const& neighbor : neighbors) {
+        //when more than one neighbor evaluated a point, the nearest is used
+        prior.insert(std::begin(neighbor.history), std::end(neighbor.history));
+      }
+      if(prior.empty()) return;
+
+      pressio_options warm_options;
+      pressio_search_results::input_type warm_lower = lower_bound, warm_upper = upper_bound;
+      if(objective_mode == pressio_search_mode_target && target) {
+        auto bracket = find_bracket(prior, *target);
+        if(bracket) {
+          //the response of this data differs somewhat, so keep a neighboring evaluation of margin on each side
+          auto lower = prior.find({bracket->first});
+          auto upper = prior.find({bracket->second});
+          if(lower != std::begin(prior)) --lower;
+          if(std::next(upper) != std::end(prior)) ++upper;
+          double narrowed_lower = lower->first.front(), narrowed_upper = upper->first.front();
+          if(lower_bound.size() == 1) narrowed_lower = std::max(narrowed_lower, lower_bound.front());
+          if(upper_bound.size() == 1) narrowed_upper = std::min(narrowed_upper, upper_bound.front());
+          if(narrowed_lower < narrowed_upper) {
+            warm_lower = {narrowed_lower};
+            warm_upper = {narrowed_upper};
+            warm_options.set("opt:lower_bound", pressio_data{narrowed_lower});
+            warm_options.set("opt:upper_bound", pressio_data{narrowed_upper});
+          }
+        }
+      }
+
+      auto within = [&](pressio_search_results::input_type const& input) {
+        for (size_t dim = 0; dim < input.size(); ++dim) {
+          if(dim < warm_lower.size() && input[dim] < warm_lower[dim]) return false;
+          if(dim < warm_upper.size() && input[dim] > warm_upper[dim]) return false;
+        }
+        return true;
+      };
+      pressio_search_history evaluated;
+      for (auto const& neighbor : neighbors) {
+        if(budget.expired()) break;
+        auto best = std::min_element(std::begin(neighbor.history), std::end(neighbor.history),
+            [this](pressio_search_history::value_type const& lhs, pressio_search_history::value_type const& rhs) {
+              return objective_loss(lhs.second.front()) < objective_loss(rhs.second.front());
+            });
+        if(best == std::end(neighbor.history) || !within(best->first) || evaluated.count(best->first)) continue;
+        evaluated.emplace(best->first, compress_fn(best->first));
+      }
+      warm_start_evaluations = evaluated.size();
+      warm_options.set("opt:evaluations", seed_evaluations(evaluated, constraints, input_settings.size(), evaluations_data, warm_lower, warm_upper));
+      search->set_options(warm_options);
+    }
+
+    /**
+     * \returns the loss of an objective value, lower is better
+     */
+    double objective_loss(double value) const {
+      switch(objective_mode) {
+        case pressio_search_mode_max:
+          return -value;
+        case pressio_search_mode_min:
+          return value;
+        case pressio_search_mode_target:
+          return (target) ? std::abs(value - *target) : 0.0;
+        default:
+          return 0.0;
+      }
+    }
+
+    /**
+     * runs the proxy compressor for an input
+     *
+     * \returns the proxy's prediction if it is worse than the incumbent by more than the margin,
+     * otherwise the input needs to be evaluated
+     */
+    compat::optional<std::vector<double>> screen_candidate(pressio_search_results::input_type const& input_v,
+        compat::span<const pressio_data* const> const& input_datas,
+        compat::span<pressio_data*> const& thread_outputs) {
+      compat::optional<double> incumbent, incumbent_objective;
+      {
+        std::lock_guard<std::mutex> guard(history_mutex);
+        incumbent = incumbent_loss;
+        incumbent_objective = incumbent_value;
+      }
+      //the incumbent is only comparable within a single objective with a known direction
+      const bool screenable = (objective_mode == pressio_search_mode_min || objective_mode == pressio_search_mode_max ||
+          (objective_mode == pressio_search_mode_target && target)) && targets.size() <= 1;
+      if(not incumbent || not screenable) return {};
+
+      auto const& names = (screen_outputs.empty()) ? output_settings : screen_outputs;
+      if(names.size() != output_settings.size()) {
+        throw pressio_search_exception("opt:screen_outputs must have one metric for each of opt:output");
+      }
+      pressio_compressor proxy = screen->clone();
+      std::vector<pressio_data> proxy_outputs;
+      std::vector<pressio_data*> proxy_outputs_ptrs;
+      std::transform(std::begin(thread_outputs), std::end(thread_outputs), std::back_inserter(proxy_outputs),
+          [](pressio_data* data) {
+            return pressio_data::clone(*data);
+          });
+      std::transform(std::begin(proxy_outputs), std::end(proxy_outputs), std::back_inserter(proxy_outputs_ptrs),
+          [](pressio_data& data) {
+            return &data;
+          });
+      compat::span<pressio_data*> proxy_outputs_span(proxy_outputs_ptrs.data(), proxy_outputs_ptrs.data()+proxy_outputs_ptrs.size());
+      auto predicted = evaluate_compressor(proxy, input_v, input_datas, proxy_outputs_span, names);
+
+      const double scale = std::abs((objective_mode == pressio_search_mode_target) ? *target : *incumbent_objective);
+      if(objective_loss(predicted.front()) > *incumbent + screen_margin * scale) {
+        std::lock_guard<std::mutex> guard(history_mutex);
+        ++screen_skipped;
+        return predicted;
+      }
+      return {};
+    }
+
+    /**
+     * \returns the index of the candidate compressor selected by opt:compressor_index, or 0 if it is not an input
+     */
+    size_t compressor_index(pressio_search_results::input_type const& input_v) const {
+      auto setting = std::find(std::begin(input_settings), std::end(input_settings), compressor_index_setting);
+      if(setting == std::end(input_settings)) return 0;
+      if(candidates.empty()) {
+        throw pressio_search_exception(compressor_index_setting + " requires opt:compressors to be set");
+      }
+      auto index = std::llround(input_v.at(std::distance(std::begin(input_settings), setting)));
+      return static_cast<size_t>(std::min<long long>(std::max<long long>(index, 0), candidates.size() - 1));
+    }
+
+    /**
+     * \returns the compressor configured by the given input
+     */
+    pressio_compressor const& compressor_for(pressio_search_results::input_type const& input_v) const {
+      if(candidates.empty()) return compressor;
+      return candidates[compressor_index(input_v)];
+    }
+
+    /**
+     * \returns the compressor used for the last compression
+     */
+    pressio_compressor& active_compressor() {
+      if(candidates.empty()) return compressor;
+      return candidates[selected_compressor];
+    }
+
     int is_thread_safe() const {
       int mpi_init=0;
       MPI_Initialized(&mpi_init);
 
       pressio_thread_safety compressor_thread_safety = get_threadsafe(*compressor);
+      for (auto const& candidate : candidates) {
+        compressor_thread_safety = std::min(compressor_thread_safety, get_threadsafe(*candidate));
+      }
+      if(screen) {
+        compressor_thread_safety = std::min(compressor_thread_safety, get_threadsafe(*screen));
+      }
 
       if(mpi_init) {
         int mpi_thread_provided;
@@ -374,23 +942,61 @@ class pressio_opt_plugin: public libpressio_compressor_plugin {
 
     pressio library{};
     pressio_compressor compressor{};
+    std::vector<pressio_compressor> candidates;
+    size_t selected_compressor = 0;
+    pressio_compressor screen{};
     pressio_search search{};
     pressio_search_metrics search_metrics{};
     compat::optional<pressio_search_results> last_results;
+    std::vector<pressio_search_results> target_results;
 
     std::string compressor_method="noop";
+    std::vector<std::string> compressor_methods;
+    std::string screen_method;
+    std::vector<std::string> screen_outputs;
+    double screen_margin = .1;
+    unsigned int objective_mode = pressio_search_mode_target;
+    compat::optional<pressio_search_results::output_type::value_type> target;
     std::string search_method="guess";
     std::string search_metrics_method="progress_printer";
     std::vector<std::string> input_settings{};
     std::vector<std::string> output_settings;
     int do_decompress = 1;
+    std::vector<pressio_search_results::output_type::value_type> targets;
+    double global_rel_tolerance = .1;
+    pressio_search_results::input_type lower_bound;
+    pressio_search_results::input_type upper_bound;
+    pressio_data evaluations_data;
+    double time_budget = std::numeric_limits<double>::max();
+    pressio_search_constraints constraints;
+    std::mutex feasibility_mutex;
+    std::vector<int32_t> feasibility;
+    std::mutex history_mutex;
+    pressio_search_history history;
+    compat::optional<double> incumbent_loss;
+    compat::optional<double> incumbent_value;
+    uint64_t screen_skipped = 0;
+    int warm_start = 0;
+    std::string warm_start_path;
+    unsigned int warm_start_neighbors = 3;
+    uint64_t warm_start_used = 0;
+    uint64_t warm_start_evaluations = 0;
+    pressio_search_results::input_type prediction;
+    uint64_t screen_evaluated = 0;
 
     std::vector<std::string> children_impl() const override {
-        return {
+        std::vector<std::string> children{
             compressor->get_name(),
             search->get_name(),
             search_metrics->get_name(),
         };
+        for (auto const& candidate : candidates) {
+          children.emplace_back(candidate->get_name());
+        }
+        if(screen) {
+          children.emplace_back(screen->get_name());
+        }
+        return children;
     }
 };
 
@@ -0,0 +1,79 @@
+#ifndef PRESSIO_SEARCH_BUDGET_H
+#define PRESSIO_SEARCH_BUDGET_H
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <std_compat/optional.h>
+
+/**
+ * \file
+ * \brief private helper to track the wall-clock budget of a search
+ */
+
+/**
+ * tracks the remaining wall-clock time of a search.
+ *
+ * Budgets are passed between searchers as the number of seconds remaining
+ * using the `opt:time_budget` option; std::numeric_limits<double>::max() means unlimited
+ */
+class pressio_search_budget {
+  public:
+  /** the clock used to measure the budget */
+  using clock = std::chrono::steady_clock;
+
+  /** construct an unlimited budget */
+  pressio_search_budget()=default;
+
+  /**
+   * construct a budget that expires after seconds
+   * \param[in] seconds the number of seconds available from now
+   */
+  explicit pressio_search_budget(double seconds) {
+    using secs = std::chrono::duration<double>;
+    auto const now = clock::now();
+    if(seconds < secs(clock::time_point::max() - now).count()) {
+      deadline = now + std::chrono::duration_cast<clock::duration>(secs(std::max(seconds, 0.0)));
+    }
+  }
+
+  /** \returns true if the budget is limited */
+  bool limited() const {
+    return bool(deadline);
+  }
+
+  /** \returns true if the budget has been used */
+  bool expired() const {
+    return deadline && clock::now() >= *deadline;
+  }
+
+  /** \returns the number of seconds remaining in the budget */
+  double remaining() const {
+    if(not deadline) return std::numeric_limits<double>::max();
+    return std::max(0.0, std::chrono::duration<double>(*deadline - clock::now()).count());
+  }
+
+  /**
+   * \param[in] parts the number of sequential parts that remain
+   * \returns the number of seconds each remaining part may use
+   */
+  double share(size_t parts) const {
+    if(not deadline || parts <= 1) return remaining();
+    return remaining() / static_cast<double>(parts);
+  }
+
+  /**
+   * \param[in] max_seconds a per-searcher limit that should also be respected
+   * \returns the runtime limit that respects both the budget and max_seconds
+   */
+  std::chrono::nanoseconds max_runtime(double max_seconds) const {
+    using secs = std::chrono::duration<double>;
+    const double limit = std::min({max_seconds, remaining(), secs(std::chrono::nanoseconds::max()).count() / 2});
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(secs(limit));
+  }
+
+  private:
+  compat::optional<clock::time_point> deadline;
+};
+
+#endif /* end of include guard: PRESSIO_SEARCH_BUDGET_H */
@@ -0,0 +1,232 @@
+#ifndef PRESSIO_SEARCH_CONSTRAINTS_H
+#define PRESSIO_SEARCH_CONSTRAINTS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <libpressio_ext/cpp/data.h>
+#include <libpressio_ext/cpp/options.h>
+#include "pressio_search_results.h"
+
+/**
+ * \file
+ * \brief private helpers to evaluate `opt:constraints`
+ */
+
+/**
+ * constraints on the outputs of a search of the form "<output> >= <value>" or "<output> <= <value>"
+ */
+class pressio_search_constraints {
+  public:
+  /**
+   * reads `opt:constraints`, `opt:constraints_monotone`, and `opt:output` from options
+   *
+   * \param[in] options the options passed to the search plugin
+   * \param[in] name the name of the search plugin
+   * \param[out] err the reason the constraints are invalid if they are
+   * \returns 0 on success, non-zero if the constraints are invalid
+   */
+  int set_options(pressio_options const& options, std::string const& name, std::string& err) {
+    bool changed = false;
+    changed |= options.get(name, "opt:constraints", &constraint_strs) == pressio_options_key_set;
+    changed |= options.get(name, "opt:output", &output_names) == pressio_options_key_set;
+    pressio_data data;
+    if(options.get(name, "opt:constraints_monotone", &data) == pressio_options_key_set) {
+      monotone_directions = data.to_vector<double>();
+    }
+    if(changed) return parse(err);
+    return 0;
+  }
+
+  /** \returns the constraints as provided by the user */
+  std::vector<std::string> const& constraints() const {
+    return constraint_strs;
+  }
+
+  /**
+   * \returns for each input, +1 if increasing the input can only make the
+   * constraints more violated, -1 if decreasing it can only make them more
+   * violated, and 0 if unknown; empty if not provided
+   */
+  std::vector<double> const& monotone() const {
+    return monotone_directions;
+  }
+
+  /** \returns true if there are no constraints */
+  bool empty() const {
+    return parsed_constraints.empty();
+  }
+
+  /**
+   * \param[in] output the outputs of an evaluation
+   * \returns the total violation of the constraints relative to their bounds, 0 if feasible
+   */
+  double violation(pressio_search_results::output_type const& output) const {
+    double total = 0;
+    for (auto const& c : parsed_constraints) {
+      if(c.index >= output.size() || std::isnan(output[c.index])) return std::numeric_limits<double>::infinity();
+      const double diff = (c.is_lower) ? (c.bound - output[c.index]) : (output[c.index] - c.bound);
+      if(diff > 0) {
+        total += diff / std::max(std::abs(c.bound), std::numeric_limits<double>::min());
+      }
+    }
+    return total;
+  }
+
+  /**
+   * \param[in] output the outputs of an evaluation
+   * \returns true if the outputs satisfy every constraint
+   */
+  bool feasible(pressio_search_results::output_type const& output) const {
+    return violation(output) == 0;
+  }
+
+  private:
+  int parse(std::string& err) {
+    std::vector<constraint> parsed;
+    if(output_names.empty()) {
+      //opt:output has not been provided yet, parse when it is
+      parsed_constraints.clear();
+      return 0;
+    }
+    for (auto const& constraint_str : constraint_strs) {
+      constraint c;
+      auto op = constraint_str.find(">=");
+      c.is_lower = op != std::string::npos;
+      if(!c.is_lower) op = constraint_str.find("<=");
+      if(op == std::string::npos) {
+        err = "constraint is not of the form <output> >= <value> or <output> <= <value>: " + constraint_str;
+        return 1;
+      }
+      auto const name = trim(constraint_str.substr(0, op));
+      auto const it = std::find(std::begin(output_names), std::end(output_names), name);
+      if(it == std::end(output_names)) {
+        err = "constraint refers to an output that is not in opt:output: " + name;
+        return 1;
+      }
+      c.index = std::distance(std::begin(output_names), it);
+      try {
+        c.bound = std::stod(constraint_str.substr(op+2));
+      } catch(std::exception const&) {
+        err = "constraint has an invalid bound: " + constraint_str;
+        return 1;
+      }
+      parsed.push_back(c);
+    }
+    parsed_constraints = std::move(parsed);
+    return 0;
+  }
+
+  struct constraint {
+    size_t index;
+    double bound;
+    bool is_lower;
+  };
+  static std::string trim(std::string const& str) {
+    auto const begin = str.find_first_not_of(" \t");
+    if(begin == std::string::npos) return "";
+    auto const end = str.find_last_not_of(" \t");
+    return str.substr(begin, end - begin + 1);
+  }
+  std::vector<std::string> constraint_strs;
+  std::vector<std::string> output_names;
+  std::vector<double> monotone_directions;
+  std::vector<constraint> parsed_constraints;
+};
+
+/**
+ * records the feasibility of the evaluations of a single search, and when
+ * the directions in which the constraints are monotone are provided,
+ * identifies inputs that must be infeasible without evaluating them.
+ *
+ * An input is pruned if, for some infeasible input i, it is at least as far as
+ * i in the direction of each monotone input, and equal to i in the others.
+ *
+ * This class is thread-safe.
+ */
+class pressio_search_feasibility {
+  public:
+  /**
+   * \param[in] constraints the constraints to check
+   */
+  explicit pressio_search_feasibility(pressio_search_constraints const& constraints):
+    constraints(constraints), directions(constraints.monotone()) {}
+
+  /**
+   * records an evaluation
+   * \param[in] input the input that was evaluated
+   * \param[in] output the output of the evaluation
+   * \returns true if the evaluation was feasible
+   */
+  bool record(pressio_search_results::input_type const& input, pressio_search_results::output_type const& output) {
+    const bool is_feasible = feasible(input, output);
+    if(constraints.empty() || directions.size() != input.size() || is_feasible) return is_feasible;
+    std::lock_guard<std::mutex> guard(mutex);
+    infeasible_inputs.push_back(input);
+    return is_feasible;
+  }
+
+  /**
+   * treats an input as feasible whatever its outputs, for prior evaluations from `opt:evaluations`
+   * which only carry the objective; searches that hand evaluations to a child drop the infeasible
+   * ones first, see seed_evaluations
+   *
+   * \param[in] input the input of the prior evaluation
+   */
+  void assume_feasible(pressio_search_results::input_type const& input) {
+    if(constraints.empty()) return;
+    std::lock_guard<std::mutex> guard(mutex);
+    assumed_inputs.insert(input);
+  }
+
+  /**
+   * \param[in] input the input that was evaluated
+   * \param[in] output the output of the evaluation
+   * \returns true if the evaluation is feasible or input was passed to assume_feasible
+   */
+  bool feasible(pressio_search_results::input_type const& input, pressio_search_results::output_type const& output) const {
+    if(constraints.feasible(output)) return true;
+    std::lock_guard<std::mutex> guard(mutex);
+    return assumed_inputs.count(input) != 0;
+  }
+
+  /**
+   * \param[in] input the input to check
+   * \returns true if the input is known to be infeasible without evaluating it
+   */
+  bool pruned(pressio_search_results::input_type const& input) const {
+    if(constraints.empty() || directions.size() != input.size()) return false;
+    std::lock_guard<std::mutex> guard(mutex);
+    return std::any_of(std::begin(infeasible_inputs), std::end(infeasible_inputs),
+        [&input, this](pressio_search_results::input_type const& infeasible) {
+          return dominates(input, infeasible);
+        });
+  }
+
+  private:
+  bool dominates(pressio_search_results::input_type const& input, pressio_search_results::input_type const& infeasible) const {
+    for (size_t dim = 0; dim < input.size(); ++dim) {
+      if(directions[dim] == 0) {
+        if(input[dim] != infeasible[dim]) return false;
+      } else if((input[dim] - infeasible[dim]) * directions[dim] < 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  pressio_search_constraints const& constraints;
+  std::vector<double> const directions;
+  mutable std::mutex mutex;
+  std::vector<pressio_search_results::input_type> infeasible_inputs;
+  std::set<pressio_search_results::input_type> assumed_inputs;
+};
+
+#endif /* end of include guard: PRESSIO_SEARCH_CONSTRAINTS_H */
@@ -0,0 +1,369 @@
+#ifndef PRESSIO_SEARCH_EVALUATIONS_H
+#define PRESSIO_SEARCH_EVALUATIONS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <libpressio_ext/cpp/data.h>
+#include <std_compat/optional.h>
+#include "pressio_search.h"
+#include "pressio_search_results.h"
+#include "pressio_search_constraints.h"
+
+/**
+ * \file
+ * \brief private helpers to convert between evaluation histories and the
+ * `opt:evaluations` layout of double[n_inputs + 1, n_evaluations]
+ */
+
+/** a history of evaluations, mapping the inputs to the outputs that were observed */
+using pressio_search_history = std::map<pressio_search_results::input_type, pressio_search_results::output_type>;
+
+/**
+ * convert a history into the `opt:evaluations` layout
+ *
+ * \param[in] history the evaluations to convert, the first output is used as the objective
+ * \param[in] n_inputs the number of inputs for each evaluation
+ * \param[in] prior evaluations in the `opt:evaluations` layout to prepend if they have a matching width
+ * \returns a pressio_data of dimensions {n_inputs+1, n_evaluations}
+ */
+inline pressio_data history_to_evaluations(pressio_search_history const& history, const size_t n_inputs, pressio_data const& prior = pressio_data()) {
+  const size_t width = n_inputs + 1;
+  size_t n_prior = 0;
+  if(prior.has_data() && prior.num_dimensions() == 2 && prior.get_dimension(0) == width) {
+    n_prior = prior.get_dimension(1);
+  }
+  size_t n_history = std::count_if(std::begin(history), std::end(history), [n_inputs](pressio_search_history::value_type const& eval) {
+      return eval.first.size() == n_inputs && !eval.second.empty();
+  });
+  if(n_prior + n_history == 0) return pressio_data();
+
+  auto evaluations = pressio_data::owning(pressio_double_dtype, {width, n_prior + n_history});
+  double* ptr = static_cast<double*>(evaluations.data());
+  if(n_prior) {
+    auto prior_v = prior.to_vector<double>();
+    ptr = std::copy(std::begin(prior_v), std::begin(prior_v) + width*n_prior, ptr);
+  }
+  for (auto const& eval : history) {
+    if(eval.first.size() != n_inputs || eval.second.empty()) continue;
+    ptr = std::copy(std::begin(eval.first), std::end(eval.first), ptr);
+    *ptr++ = eval.second.front();
+  }
+  return evaluations;
+}
+
+/**
+ * convert data in the `opt:evaluations` layout into a history
+ *
+ * \param[in] data the evaluations to convert
+ * \param[in] n_inputs the number of inputs for each evaluation
+ * \returns a history where each output contains only the objective
+ * \throws std::runtime_error if the dimensions of data are invalid
+ */
+inline pressio_search_history evaluations_to_history(pressio_data const& data, const size_t n_inputs) {
+  pressio_search_history history;
+  if(data.num_dimensions() == 0 || (not data.has_data())) {
+    return history;
+  }
+  if(data.num_dimensions() != 2) {
+    std::ostringstream err;
+    err << "invalid_dimensions: should be 2d but is " << data.num_dimensions();
+    throw std::runtime_error(err.str());
+  }
+  const size_t width = n_inputs + 1;
+  if(data.get_dimension(0) != width) {
+    std::ostringstream err;
+    err << "invalid_dimensions: dim[0] should be "  << width << " but is " << data.get_dimension(0);
+    throw std::runtime_error(err.str());
+  }
+  auto data_v = data.to_vector<double>();
+  const double* ptr = data_v.data();
+  for (size_t i = 0; i < data.get_dimension(1); ++i) {
+    history[pressio_search_results::input_type(ptr+(i*width), ptr+(i*width)+n_inputs)] = {ptr[i*width+n_inputs]};
+  }
+  return history;
+}
+
+/**
+ * the evaluations a parent search hands to a child search as its `opt:evaluations`
+ *
+ * Parent searches call this with every evaluation they have made so far so that no evaluation is
+ * repeated by the child.  Only evaluations within the bounds of the child are passed, and evaluations
+ * made by the parent replace prior evaluations of the same point.  Evaluations made by the parent that
+ * failed or violate its constraints are dropped, since the child only sees the objective and would
+ * otherwise take them as feasible.
+ *
+ * \param[in] history the evaluations made by the parent
+ * \param[in] constraints the constraints of the parent
+ * \param[in] n_inputs the number of inputs for each evaluation
+ * \param[in] prior the evaluations passed to the parent in the `opt:evaluations` layout, returned unchanged if invalid
+ * \param[in] lower the lower bound of the child, unbounded if empty
+ * \param[in] upper the upper bound of the child, unbounded if empty
+ * \returns a pressio_data of dimensions {n_inputs+1, n_evaluations}
+ */
+inline pressio_data seed_evaluations(pressio_search_history const& history,
+    pressio_search_constraints const& constraints, const size_t n_inputs,
+    pressio_data const& prior = pressio_data(),
+    pressio_search_results::input_type const& lower = {},
+    pressio_search_results::input_type const& upper = {}) {
+  pressio_search_history seeds;
+  try {
+    seeds = evaluations_to_history(prior, n_inputs);
+  } catch(std::runtime_error const&) {
+    //leave invalid priors for the child to report
+    return prior;
+  }
+  for (auto const& eval : history) {
+    if(eval.second.empty() || !constraints.feasible(eval.second)) {
+      seeds.erase(eval.first);
+    } else {
+      seeds[eval.first] = eval.second;
+    }
+  }
+  auto within = [&](pressio_search_results::input_type const& input) {
+    for (size_t dim = 0; dim < input.size(); ++dim) {
+      if(dim < lower.size() && input[dim] < lower[dim]) return false;
+      if(dim < upper.size() && input[dim] > upper[dim]) return false;
+    }
+    return true;
+  };
+  for (auto it = std::begin(seeds); it != std::end(seeds);) {
+    if(within(it->first)) ++it;
+    else it = seeds.erase(it);
+  }
+  return history_to_evaluations(seeds, n_inputs);
+}
+
+/**
+ * restores the `opt:evaluations` of a child search when it goes out of scope, including when the child throws
+ */
+class pressio_search_evaluations_guard {
+  public:
+  /**
+   * \param[in] child the child search, which must outlive the guard
+   * \param[in] evaluations the evaluations to restore
+   */
+  pressio_search_evaluations_guard(pressio_search& child, pressio_data evaluations):
+    child(child), evaluations(std::move(evaluations)) {}
+  pressio_search_evaluations_guard(pressio_search_evaluations_guard const&)=delete;
+  pressio_search_evaluations_guard& operator=(pressio_search_evaluations_guard const&)=delete;
+  ~pressio_search_evaluations_guard() {
+    pressio_options restore_options;
+    restore_options.set("opt:evaluations", evaluations);
+    child->set_options(restore_options);
+  }
+
+  private:
+  pressio_search& child;
+  pressio_data evaluations;
+};
+
+/**
+ * snapshots the options of a search and restores them when it goes out of scope,
+ * even if the search throws
+ */
+class pressio_search_options_guard {
+  public:
+  /**
+   * \param[in] search the search, which must outlive the guard
+   */
+  explicit pressio_search_options_guard(pressio_search const& search): search(search), saved(search->get_options()) {}
+  pressio_search_options_guard(pressio_search_options_guard const&)=delete;
+  pressio_search_options_guard& operator=(pressio_search_options_guard const&)=delete;
+  ~pressio_search_options_guard() {
+    search->set_options(saved);
+  }
+
+  /** \returns the options of the search before it was reconfigured */
+  pressio_options const& options() const {
+    return saved;
+  }
+
+  /**
+   * also restores an option that the search accepts but does not report, such as its communicator
+   * \param[in] key the option to restore
+   * \param[in] value the value to restore it to
+   */
+  template <class T>
+  void restore(std::string const& key, T const& value) {
+    saved.set(key, value);
+  }
+
+  private:
+  pressio_search const& search;
+  pressio_options saved;
+};
+
+/**
+ * a thread-safe cache of evaluations shared by one or more searches
+ *
+ * points that have already been evaluated are answered from the cache
+ * instead of calling the compression function again, and concurrent requests
+ * for a point that is being evaluated wait for that evaluation instead of
+ * starting another.
+ *
+ * When a tolerance is given, the bounds are divided into a grid of cells that are
+ * tolerance*(upper-lower) wide in each dimension, and only the first point
+ * requested in a cell is evaluated.  Later points in the cell are answered with
+ * its outputs, so results should report the point that was evaluated, see find_evaluation.
+ */
+class pressio_search_cache {
+  public:
+  /** type of the function used to compute evaluations */
+  using compress_fn_t = std::function<pressio_search_results::output_type(pressio_search_results::input_type const&)>;
+
+  /**
+   * \param[in] compress_fn the function used to compute evaluations that are not in the cache
+   * \param[in] lower the lower bound of each input, used only when tolerance is positive
+   * \param[in] upper the upper bound of each input, used only when tolerance is positive
+   * \param[in] tolerance the width of a cell as a fraction of the bounds, 0 for exact matches only
+   */
+  explicit pressio_search_cache(compress_fn_t compress_fn,
+      pressio_search_results::input_type lower = {},
+      pressio_search_results::input_type upper = {},
+      double tolerance = 0):
+    compress_fn(std::move(compress_fn)), lower(std::move(lower)), upper(std::move(upper)), tolerance(tolerance) {}
+
+  /**
+   * \param[in] input the point to evaluate
+   * \returns the outputs for input, either from the cache or from the compression function
+   */
+  pressio_search_results::output_type operator()(pressio_search_results::input_type const& input) {
+    auto const k = key(input);
+    std::promise<pressio_search_results::output_type> promise;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      auto const it = evaluations.find(k);
+      if(it != evaluations.end()) {
+        auto const future = it->second.second;
+        if(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+          ++n_hits;
+        } else {
+          ++n_coalesced;
+        }
+        lock.unlock();
+        return future.get();
+      }
+      ++n_misses;
+      evaluations.emplace(k, std::make_pair(input, promise.get_future().share()));
+    }
+    try {
+      auto output = compress_fn(input);
+      promise.set_value(output);
+      return output;
+    } catch(...) {
+      //let waiting requests see the error, and let later requests try again
+      promise.set_exception(std::current_exception());
+      std::lock_guard<std::mutex> guard(mutex);
+      evaluations.erase(k);
+      throw;
+    }
+  }
+
+  /**
+   * adds an evaluation that was made elsewhere, such as a prior evaluation
+   *
+   * an evaluation already in the cell of input is kept, since its outputs may have been
+   * returned for other points in the cell
+   *
+   * \param[in] input the point that was evaluated
+   * \param[in] output the outputs of the evaluation
+   */
+  void insert(pressio_search_results::input_type const& input, pressio_search_results::output_type const& output) {
+    std::promise<pressio_search_results::output_type> promise;
+    promise.set_value(output);
+    std::lock_guard<std::mutex> guard(mutex);
+    evaluations.emplace(key(input), std::make_pair(input, promise.get_future().share()));
+  }
+
+  /**
+   * \param[in] input the point to look up
+   * \returns the outputs for input if it has been evaluated
+   */
+  compat::optional<pressio_search_results::output_type> find(pressio_search_results::input_type const& input) const {
+    auto const evaluation = find_evaluation(input);
+    if(!evaluation) return compat::optional<pressio_search_results::output_type>();
+    return evaluation->second;
+  }
+
+  /**
+   * \param[in] input the point to look up
+   * \returns the point that was evaluated for input and its outputs if it has been evaluated,
+   * which differs from input when a tolerance is used
+   */
+  compat::optional<pressio_search_history::value_type> find_evaluation(pressio_search_results::input_type const& input) const {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto const it = evaluations.find(key(input));
+    if(it == evaluations.end()) return compat::optional<pressio_search_history::value_type>();
+    auto const evaluated = it->second.first;
+    auto const future = it->second.second;
+    lock.unlock();
+    try {
+      return pressio_search_history::value_type(evaluated, future.get());
+    } catch(...) {
+      return compat::optional<pressio_search_history::value_type>();
+    }
+  }
+
+  /** \returns a copy of the evaluations that have completed so far */
+  pressio_search_history history() const {
+    pressio_search_history completed;
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto const& eval : evaluations) {
+      auto const& future = eval.second.second;
+      if(future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) continue;
+      try {
+        completed.emplace(eval.second.first, future.get());
+      } catch(...) {
+        //failed evaluations are not part of the history
+      }
+    }
+    return completed;
+  }
+
+  /** \returns the number of requests answered from a completed evaluation */
+  size_t hits() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return n_hits;
+  }
+  /** \returns the number of requests that waited on an evaluation in progress */
+  size_t coalesced() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return n_coalesced;
+  }
+  /** \returns the number of requests that called the compression function */
+  size_t misses() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return n_misses;
+  }
+
+  private:
+  pressio_search_results::input_type key(pressio_search_results::input_type input) const {
+    if(tolerance <= 0) return input;
+    for (size_t dim = 0; dim < input.size() && dim < lower.size() && dim < upper.size(); ++dim) {
+      const double width = tolerance * (upper[dim] - lower[dim]);
+      if(width > 0) input[dim] = std::floor((input[dim] - lower[dim]) / width);
+    }
+    return input;
+  }
+
+  compress_fn_t compress_fn;
+  pressio_search_results::input_type const lower;
+  pressio_search_results::input_type const upper;
+  double const tolerance;
+  mutable std::mutex mutex;
+  std::map<pressio_search_results::input_type,
+    std::pair<pressio_search_results::input_type, std::shared_future<pressio_search_results::output_type>>> evaluations;
+  size_t n_hits = 0;
+  size_t n_coalesced = 0;
+  size_t n_misses = 0;
+};
+
+#endif /* end of include guard: PRESSIO_SEARCH_EVALUATIONS_H */
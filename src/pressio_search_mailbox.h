@@ -0,0 +1,140 @@
+#ifndef PRESSIO_SEARCH_MAILBOX_H
+#define PRESSIO_SEARCH_MAILBOX_H
+
+#include <list>
+#include <utility>
+#include <vector>
+#include <mpi.h>
+
+/**
+ * \file
+ * \brief private helper for searchers whose ranks exchange messages without waiting on each other
+ */
+
+/**
+ * tracks the messages sent to other ranks so that they can be completed without blocking
+ *
+ * messages are sent with synchronous sends so that once every send completes and every rank
+ * has reached a non-blocking barrier, no messages remain in flight.
+ *
+ * Constructing a mailbox duplicates the communicator, so every rank of it must construct one.
+ */
+class pressio_search_mailbox {
+  public:
+  /**
+   * \param[in] parent the communicator of the ranks that exchange messages
+   */
+  explicit pressio_search_mailbox(MPI_Comm parent) {
+    MPI_Comm_dup(parent, &comm);
+  }
+  pressio_search_mailbox(pressio_search_mailbox const&)=delete;
+  pressio_search_mailbox& operator=(pressio_search_mailbox const&)=delete;
+  ~pressio_search_mailbox() {
+    MPI_Comm_free(&comm);
+  }
+
+  /** \returns the rank of this process in the mailbox's communicator */
+  int rank() const {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    return rank;
+  }
+
+  /** \returns the number of ranks in the mailbox's communicator */
+  int size() const {
+    int size;
+    MPI_Comm_size(comm, &size);
+    return size;
+  }
+
+  /**
+   * starts sending a message without waiting for it to be received
+   * \param[in] message the message to send
+   * \param[in] dest the rank to send it to
+   * \param[in] tag the tag passed to the handler of the receiver
+   */
+  void send(std::vector<double> message, int dest, int tag) {
+    outbox.emplace_back(std::move(message), MPI_REQUEST_NULL);
+    auto& sent = outbox.back();
+    MPI_Issend(sent.first.data(), static_cast<int>(sent.first.size()), MPI_DOUBLE, dest, tag, comm, &sent.second);
+  }
+
+  /** receives every message that has arrived and passes it to handler(tag, message) */
+  template <class Handler>
+  void poll(Handler&& handler) {
+    int flag = 1;
+    while(flag) {
+      MPI_Status status;
+      MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &flag, &status);
+      if(!flag) break;
+      int count;
+      MPI_Get_count(&status, MPI_DOUBLE, &count);
+      std::vector<double> message(count);
+      MPI_Recv(message.data(), count, MPI_DOUBLE, status.MPI_SOURCE, status.MPI_TAG, comm, MPI_STATUS_IGNORE);
+      handler(status.MPI_TAG, message);
+    }
+    //release the buffers of completed sends
+    outbox.remove_if([](std::pair<std::vector<double>, MPI_Request>& sent) {
+      int done;
+      MPI_Test(&sent.second, &done, MPI_STATUS_IGNORE);
+      return done != 0;
+    });
+  }
+
+  /** completes every send, receiving messages from ranks that are still running until all ranks are finished */
+  template <class Handler>
+  void drain(Handler&& handler) {
+    while(!outbox.empty()) {
+      poll(handler);
+    }
+    MPI_Request barrier;
+    MPI_Ibarrier(comm, &barrier);
+    int done = 0;
+    while(!done) {
+      poll(handler);
+      MPI_Test(&barrier, &done, MPI_STATUS_IGNORE);
+    }
+  }
+
+  /**
+   * collective: finds the rank with the lowest loss, ties go to the lowest rank
+   * \param[in] loss the loss of the best point of this rank
+   * \returns the rank with the lowest loss
+   */
+  int best_rank(double loss) const {
+    struct {
+      double loss;
+      int rank;
+    } local_best{loss, rank()}, global_best;
+    MPI_Allreduce(&local_best, &global_best, 1, MPI_DOUBLE_INT, MPI_MINLOC, comm);
+    return global_best.rank;
+  }
+
+  /**
+   * collective: \returns true if flag is true on any rank
+   * \param[in] flag the flag of this rank
+   */
+  bool any(bool flag) const {
+    int local = flag ? 1 : 0, global = 0;
+    MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_MAX, comm);
+    return global != 0;
+  }
+
+  /**
+   * collective: replaces values on every rank with the values of root
+   * \param[in,out] values the values to send on root, and the values received on the other ranks
+   * \param[in] root the rank to send from
+   */
+  void bcast(std::vector<double>& values, int root) const {
+    unsigned long long count = values.size();
+    MPI_Bcast(&count, 1, MPI_UNSIGNED_LONG_LONG, root, comm);
+    values.resize(count);
+    MPI_Bcast(values.data(), static_cast<int>(count), MPI_DOUBLE, root, comm);
+  }
+
+  private:
+  MPI_Comm comm;
+  std::list<std::pair<std::vector<double>, MPI_Request>> outbox;
+};
+
+#endif /* end of include guard: PRESSIO_SEARCH_MAILBOX_H */
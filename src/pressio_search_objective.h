@@ -0,0 +1,335 @@
+#ifndef PRESSIO_SEARCH_OBJECTIVE_H
+#define PRESSIO_SEARCH_OBJECTIVE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <libdistributed_task_manager.h>
+#include <std_compat/optional.h>
+#include "pressio_search_defines.h"
+#include "pressio_search_results.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_transform.h"
+
+/**
+ * \file
+ * \brief private helpers shared by searchers that minimize a loss over the unit cube
+ */
+
+/**
+ * the objective of a search with a single objective: minimize, maximize, or reach a target
+ */
+class pressio_search_objective {
+  public:
+  /**
+   * \param[in] mode the pressio_search_mode of the search
+   * \param[in] target the target of the search, if any
+   * \param[in] global_rel_tolerance how close to the target is close enough in target mode
+   */
+  pressio_search_objective(unsigned int mode, compat::optional<double> target, double global_rel_tolerance):
+    mode(mode), target(std::move(target)), global_rel_tolerance(global_rel_tolerance) {}
+
+  /**
+   * \param[in] value the objective
+   * \returns the loss of an objective, lower is better; without a target, target mode minimizes
+   */
+  double loss(double value) const {
+    switch(mode) {
+      case pressio_search_mode_max:
+        return -value;
+      case pressio_search_mode_target:
+        return (target) ? std::abs(value - *target) : value;
+      case pressio_search_mode_min:
+      default:
+        return value;
+    }
+  }
+
+  /**
+   * \param[in] output the outputs of an evaluation, the first of which is the objective
+   * \returns the loss of the objective of an evaluation
+   */
+  double loss(pressio_search_results::output_type const& output) const {
+    return loss(output.front());
+  }
+
+  /**
+   * \param[in] value the objective
+   * \returns true if the objective is within tolerance of the target, or better than the target in min and max modes
+   */
+  bool is_achieved(double value) const {
+    switch(mode) {
+      case pressio_search_mode_target:
+        return target && std::abs(value - *target) <= std::abs(*target * global_rel_tolerance);
+      case pressio_search_mode_min:
+        return target && value < *target;
+      case pressio_search_mode_max:
+        return target && value > *target;
+      default:
+        return false;
+    }
+  }
+
+  private:
+  unsigned int mode;
+  compat::optional<double> target;
+  double global_rel_tolerance;
+};
+
+/**
+ * maps the search space to the unit cube and back, rounding integral inputs
+ */
+class pressio_search_unit_cube {
+  public:
+  /**
+   * \param[in] lower the lower bound of each input in the search space
+   * \param[in] upper the upper bound of each input in the search space
+   * \param[in] is_integral which inputs are integers, missing entries are not
+   * \param[in] transform the transform of the inputs, integers are only rounded where it is linear
+   */
+  pressio_search_unit_cube(pressio_search_results::input_type lower, pressio_search_results::input_type upper,
+      std::vector<bool> const& is_integral, pressio_search_transform const& transform):
+    lower(std::move(lower)), upper(std::move(upper)), integral(this->lower.size()) {
+    for (size_t dim = 0; dim < integral.size(); ++dim) {
+      integral[dim] = dim < is_integral.size() && is_integral[dim] && transform.is_linear(dim);
+    }
+  }
+
+  /** \returns the number of inputs */
+  size_t size() const {
+    return lower.size();
+  }
+
+  /** \returns true if input dim is rounded to an integer */
+  bool is_integral(size_t dim) const {
+    return integral[dim];
+  }
+
+  /** \returns the position of input in the unit cube, clamped to the bounds */
+  std::vector<double> to_unit(pressio_search_results::input_type const& input) const {
+    std::vector<double> unit(size());
+    for (size_t dim = 0; dim < size(); ++dim) {
+      const double width = upper[dim] - lower[dim];
+      unit[dim] = (width > 0) ? std::min(std::max((input[dim] - lower[dim]) / width, 0.0), 1.0) : 0.0;
+    }
+    return unit;
+  }
+
+  /** \returns the input at a position in the unit cube, with integral inputs rounded */
+  pressio_search_results::input_type from_unit(std::vector<double> const& unit) const {
+    pressio_search_results::input_type input(size());
+    for (size_t dim = 0; dim < size(); ++dim) {
+      input[dim] = lower[dim] + std::min(std::max(unit[dim], 0.0), 1.0) * (upper[dim] - lower[dim]);
+      if(integral[dim]) {
+        input[dim] = std::min(std::max(std::round(input[dim]), std::ceil(lower[dim])), std::floor(upper[dim]));
+      }
+    }
+    return input;
+  }
+
+  /**
+   * \param[in] dim the input
+   * \param[in] tolerance the smallest step for continuous inputs
+   * \returns the smallest step in the unit cube that moves the input, integral inputs cannot move less than one unit
+   */
+  double min_step(size_t dim, double tolerance) const {
+    const double width = upper[dim] - lower[dim];
+    return (integral[dim] && width > 0) ? std::max(tolerance, 1.0 / width) : tolerance;
+  }
+
+  private:
+  pressio_search_results::input_type lower;
+  pressio_search_results::input_type upper;
+  std::vector<bool> integral;
+};
+
+/**
+ * evaluates points of the unit cube for searchers that run local searches on several threads,
+ * and tracks the best feasible evaluation and when the search should stop.
+ *
+ * Points are evaluated at most once, concurrent requests for the same point wait for the same
+ * evaluation, and infeasible points have an infinite loss.
+ * This class is thread-safe.
+ */
+class pressio_search_incumbent {
+  public:
+  /** type of the function used to compute evaluations */
+  using compress_fn_t = std::function<pressio_search_results::output_type(pressio_search_results::input_type const&)>;
+
+  /**
+   * \param[in] compress_fn the function used to compute evaluations
+   * \param[in] objective the objective of the search
+   * \param[in] constraints the constraints of the search, which must outlive the incumbent
+   * \param[in] cube the mapping from the unit cube to the inputs
+   * \param[in] priors evaluations that are already known, which must all be feasible
+   * \param[in] max_evaluations the number of evaluations after which to stop
+   * \param[in] max_seconds the number of seconds after which to stop
+   * \param[in] budget the time budget of the search
+   * \param[in] token the stop token of the search, which must outlive the incumbent
+   */
+  pressio_search_incumbent(compress_fn_t compress_fn, pressio_search_objective objective,
+      pressio_search_constraints const& constraints, pressio_search_unit_cube cube, pressio_search_history priors,
+      size_t max_evaluations, unsigned int max_seconds, pressio_search_budget budget,
+      distributed::queue::StopToken& token):
+    compress_fn(std::move(compress_fn)), objective(std::move(objective)), constraints(constraints),
+    feasibility(constraints), cube(std::move(cube)), cache([this](pressio_search_results::input_type const& input) { return compute(input); }),
+    max_evaluations(max_evaluations), max_seconds(max_seconds),
+    max_time(std::chrono::system_clock::now() + std::chrono::seconds(max_seconds)),
+    budget(std::move(budget)), token(token)
+  {
+    for (auto const& eval : priors) {
+      cache.insert(eval.first, eval.second);
+      if(not best_input || this->objective.loss(eval.second) < this->objective.loss(best_output)) {
+        best_input = eval.first;
+        best_output = eval.second;
+      }
+    }
+    done = best_input && this->objective.is_achieved(best_output.front());
+  }
+
+  /** \returns true if the search should stop */
+  bool should_stop() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return should_stop_locked();
+  }
+
+  /** stops the search, such as when an evaluation failed */
+  void stop() {
+    std::lock_guard<std::mutex> guard(mutex);
+    done = true;
+  }
+
+  /**
+   * evaluates a point once
+   * \param[in] unit the point in the unit cube
+   * \param[out] value the loss of the point
+   * \returns false if the search should stop instead
+   */
+  bool evaluate(std::vector<double> const& unit, double& value) {
+    const auto input = cube.from_unit(unit);
+    if(should_stop()) return false;
+    auto const output = cache(input);
+    const bool feasible = !output.empty() && constraints.feasible(output);
+    value = feasible ? objective.loss(output) : std::numeric_limits<double>::infinity();
+    std::lock_guard<std::mutex> guard(mutex);
+    if(feasible && (not best_input || value < objective.loss(best_output))) {
+      best_input = input;
+      best_output = output;
+      done = done || objective.is_achieved(output.front());
+    }
+    return true;
+  }
+
+  /**
+   * \param[in] transform the transform from the inputs to the search space
+   * \returns the best feasible evaluation and why the search stopped
+   */
+  pressio_search_results results(pressio_search_transform const& transform) {
+    std::lock_guard<std::mutex> guard(mutex);
+    pressio_search_results results;
+    if(best_input && objective.is_achieved(best_output.front())) {
+      token.request_stop();
+    } else if(evaluations >= max_evaluations) {
+      results.status = -1;
+      results.msg = "iterations exceeded";
+    } else if(timed_out) {
+      results.status = -2;
+      results.msg = "time-limit exceeded";
+    }
+    if(best_input) {
+      results.inputs = transform.from_search(*best_input);
+      results.output = best_output;
+    } else {
+      results.status = -3;
+      results.msg = "no feasible point found";
+    }
+    return results;
+  }
+
+  private:
+  /** evaluates a point that is not in the cache, called at most once per point */
+  pressio_search_results::output_type compute(pressio_search_results::input_type const& input) {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      //points requested while the last evaluation was being started are not evaluated
+      if(evaluations >= max_evaluations) return {};
+      ++evaluations;
+    }
+    pressio_search_results::output_type output;
+    if(!feasibility.pruned(input)) {
+      output = compress_fn(input);
+      feasibility.record(input, output);
+    }
+    return output;
+  }
+
+  bool should_stop_locked() {
+    if(max_seconds > 0 && std::chrono::system_clock::now() > max_time) timed_out = true;
+    if(budget.expired()) timed_out = true;
+    return done || timed_out || evaluations >= max_evaluations || token.stop_requested();
+  }
+
+  compress_fn_t compress_fn;
+  pressio_search_objective const objective;
+  pressio_search_constraints const& constraints;
+  pressio_search_feasibility feasibility;
+  pressio_search_unit_cube const cube;
+  std::mutex mutex;
+  pressio_search_cache cache;
+  compat::optional<pressio_search_results::input_type> best_input;
+  pressio_search_results::output_type best_output;
+  bool done = false;
+  bool timed_out = false;
+  size_t evaluations = 0;
+  size_t const max_evaluations;
+  unsigned int const max_seconds;
+  std::chrono::system_clock::time_point const max_time;
+  pressio_search_budget const budget;
+  distributed::queue::StopToken& token;
+};
+
+/**
+ * runs worker on n_workers threads, or on the calling thread when n_workers is 1
+ *
+ * \param[in] n_workers the number of threads to run worker on
+ * \param[in] worker the function each thread runs until it returns
+ * \param[in] on_error called when a worker throws so that the other workers can stop; the first
+ *   exception is rethrown once every worker has returned
+ */
+template <class Worker, class OnError>
+void pressio_search_run_workers(size_t n_workers, Worker&& worker, OnError&& on_error) {
+  if(n_workers <= 1) {
+    worker();
+    return;
+  }
+  std::vector<std::exception_ptr> errors(n_workers);
+  std::vector<std::thread> threads;
+  threads.reserve(n_workers);
+  for (size_t i = 0; i < n_workers; ++i) {
+    threads.emplace_back([&, i]() {
+      try {
+        worker();
+      } catch(...) {
+        errors[i] = std::current_exception();
+        on_error();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto const& error : errors) {
+    if(error) std::rethrow_exception(error);
+  }
+}
+
+#endif /* end of include guard: PRESSIO_SEARCH_OBJECTIVE_H */
@@ -0,0 +1,239 @@
+#ifndef PRESSIO_SEARCH_SEQUENCE_H
+#define PRESSIO_SEARCH_SEQUENCE_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \brief private helper to generate points in the unit cube for sampling searches
+ */
+
+/**
+ * a sequence of points in [0,1)^n_dims where any point can be generated from its index
+ * using O(n_dims) memory regardless of the number of points.
+ *
+ * Sequences with the same seed generate the same points.
+ */
+class pressio_search_sequence {
+  public:
+  /** the kinds of sequences that can be generated */
+  enum class kind {
+    /** independent uniform random points */
+    uniform,
+    /** the Sobol low discrepancy sequence, scrambled with a random digital shift when seeded */
+    sobol,
+    /** the Halton low discrepancy sequence, scrambled with a random rotation when seeded */
+    halton,
+    /** a Latin hypercube design with exactly one point in each of n_points strata of each dimension */
+    lhs,
+  };
+
+  /**
+   * \param[in] name the name of a kind of sequence
+   * \param[out] k the kind of sequence
+   * \returns 0 if name is a kind of sequence, non-zero otherwise
+   */
+  static int parse(std::string const& name, kind& k) {
+    if(name == "uniform") k = kind::uniform;
+    else if(name == "sobol") k = kind::sobol;
+    else if(name == "halton") k = kind::halton;
+    else if(name == "lhs") k = kind::lhs;
+    else return 1;
+    return 0;
+  }
+
+  /**
+   * \param[in] k the kind of sequence
+   * \returns the maximum number of dimensions supported by the sequence
+   */
+  static size_t max_dims(kind k) {
+    return (k == kind::sobol) ? sobol_table().size() + 1 : std::numeric_limits<size_t>::max();
+  }
+
+  /**
+   * \param[in] k the kind of sequence
+   * \param[in] n_dims the number of dimensions of each point; must be at most max_dims(k)
+   * \param[in] n_points the number of points that will be generated, used for the strata of lhs
+   * \param[in] seed the seed used to randomize the sequence
+   * \param[in] scramble if false, sobol and halton are not randomized
+   */
+  pressio_search_sequence(kind k, size_t n_dims, size_t n_points, uint64_t seed, bool scramble):
+    k(k), n_dims(n_dims), n_points(std::max<size_t>(n_points, 1)), seed(seed), scramble(scramble)
+  {
+    switch(k) {
+      case kind::sobol:
+        init_sobol();
+        break;
+      case kind::halton:
+        init_halton();
+        break;
+      default:
+        break;
+    }
+  }
+
+  /**
+   * \param[in] index the index of the point to generate
+   * \returns the point in [0,1)^n_dims
+   */
+  std::vector<double> point(uint64_t index) const {
+    std::vector<double> p(n_dims);
+    for (size_t dim = 0; dim < n_dims; ++dim) {
+      switch(k) {
+        case kind::uniform:
+          p[dim] = to_unit(hash(index, dim, 0));
+          break;
+        case kind::sobol:
+          p[dim] = sobol(index, dim);
+          break;
+        case kind::halton:
+          p[dim] = halton(index, dim);
+          break;
+        case kind::lhs:
+          p[dim] = (static_cast<double>(permute(index % n_points, dim)) + to_unit(hash(index, dim, 1))) / static_cast<double>(n_points);
+          break;
+      }
+    }
+    return p;
+  }
+
+  private:
+  static uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+  uint64_t hash(uint64_t index, uint64_t dim, uint64_t stream) const {
+    return splitmix64(splitmix64(splitmix64(seed ^ stream) ^ dim) ^ index);
+  }
+  static double to_unit(uint64_t bits) {
+    return std::ldexp(static_cast<double>(bits >> 11), -53);
+  }
+
+  //Sobol direction numbers for dimensions 2-21 from Joe and Kuo's new-joe-kuo-6.21201
+  struct sobol_entry {
+    unsigned s;
+    unsigned a;
+    std::array<uint32_t, 7> m;
+  };
+  static std::array<sobol_entry, 20> const& sobol_table() {
+    static const std::array<sobol_entry, 20> table{{
+      {1, 0, {1}},
+      {2, 1, {1, 3}},
+      {3, 1, {1, 3, 1}},
+      {3, 2, {1, 1, 1}},
+      {4, 1, {1, 1, 3, 3}},
+      {4, 4, {1, 3, 5, 13}},
+      {5, 2, {1, 1, 5, 5, 17}},
+      {5, 4, {1, 1, 5, 5, 5}},
+      {5, 7, {1, 1, 7, 11, 19}},
+      {5, 11, {1, 1, 5, 1, 1}},
+      {5, 13, {1, 1, 1, 3, 11}},
+      {5, 14, {1, 3, 5, 5, 31}},
+      {6, 1, {1, 3, 3, 9, 7, 49}},
+      {6, 13, {1, 1, 1, 15, 21, 21}},
+      {6, 16, {1, 3, 1, 13, 27, 49}},
+      {6, 19, {1, 1, 1, 15, 7, 5}},
+      {6, 22, {1, 3, 1, 15, 13, 25}},
+      {6, 25, {1, 1, 5, 5, 19, 61}},
+      {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+      {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+    }};
+    return table;
+  }
+  static const size_t sobol_bits = 32;
+
+  void init_sobol() {
+    directions.assign(n_dims * sobol_bits, 0);
+    shifts.assign(n_dims, 0);
+    for (size_t dim = 0; dim < n_dims; ++dim) {
+      uint32_t* v = directions.data() + dim * sobol_bits;
+      if(dim == 0) {
+        for (size_t bit = 0; bit < sobol_bits; ++bit) v[bit] = uint32_t{1} << (31 - bit);
+      } else {
+        auto const& entry = sobol_table()[dim - 1];
+        for (size_t bit = 0; bit < sobol_bits; ++bit) {
+          if(bit < entry.s) {
+            v[bit] = entry.m[bit] << (31 - bit);
+          } else {
+            v[bit] = v[bit - entry.s] ^ (v[bit - entry.s] >> entry.s);
+            for (size_t l = 1; l < entry.s; ++l) {
+              if((entry.a >> (entry.s - 1 - l)) & 1) v[bit] ^= v[bit - l];
+            }
+          }
+        }
+      }
+      if(scramble) shifts[dim] = static_cast<uint32_t>(hash(0, dim, 2));
+    }
+  }
+  double sobol(uint64_t index, size_t dim) const {
+    //skip the first point which is always the origin before scrambling
+    uint64_t gray = (index + 1) ^ ((index + 1) >> 1);
+    uint32_t x = shifts[dim];
+    for (size_t bit = 0; gray && bit < sobol_bits; ++bit, gray >>= 1) {
+      if(gray & 1) x ^= directions[dim * sobol_bits + bit];
+    }
+    return std::ldexp(static_cast<double>(x), -32);
+  }
+
+  void init_halton() {
+    bases.clear();
+    rotations.assign(n_dims, 0.0);
+    for (uint32_t candidate = 2; bases.size() < n_dims; ++candidate) {
+      bool is_prime = true;
+      for (auto base : bases) {
+        if(base * base > candidate) break;
+        if(candidate % base == 0) { is_prime = false; break; }
+      }
+      if(is_prime) bases.push_back(candidate);
+    }
+    if(scramble) {
+      for (size_t dim = 0; dim < n_dims; ++dim) rotations[dim] = to_unit(hash(0, dim, 3));
+    }
+  }
+  double halton(uint64_t index, size_t dim) const {
+    const uint32_t base = bases[dim];
+    double inv_base = 1.0 / base, scale = inv_base, x = 0;
+    for (uint64_t i = index + 1; i > 0; i /= base, scale *= inv_base) {
+      x += static_cast<double>(i % base) * scale;
+    }
+    x += rotations[dim];
+    return x - std::floor(x);
+  }
+
+  /** a random permutation of [0,n_points) for each dimension using a cycle walking Feistel network */
+  uint64_t permute(uint64_t index, size_t dim) const {
+    unsigned half_bits = 1;
+    while((uint64_t{1} << (2 * half_bits)) < n_points) ++half_bits;
+    const uint64_t mask = (uint64_t{1} << half_bits) - 1;
+    do {
+      uint64_t left = index >> half_bits, right = index & mask;
+      for (uint64_t round = 0; round < 4; ++round) {
+        const uint64_t next = left ^ (hash(right, dim, 4 + round) & mask);
+        left = right;
+        right = next;
+      }
+      index = (left << half_bits) | right;
+    } while(index >= n_points);
+    return index;
+  }
+
+  kind k;
+  size_t n_dims;
+  size_t n_points;
+  uint64_t seed;
+  bool scramble;
+  std::vector<uint32_t> directions;
+  std::vector<uint32_t> shifts;
+  std::vector<uint32_t> bases;
+  std::vector<double> rotations;
+};
+
+#endif /* end of include guard: PRESSIO_SEARCH_SEQUENCE_H */
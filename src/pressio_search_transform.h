@@ -0,0 +1,167 @@
+#ifndef PRESSIO_SEARCH_TRANSFORM_H
+#define PRESSIO_SEARCH_TRANSFORM_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+#include <libpressio_ext/cpp/data.h>
+#include <libpressio_ext/cpp/options.h>
+#include "pressio_search_results.h"
+
+/**
+ * \file
+ * \brief private helper to apply `opt:transform` to the inputs of a search
+ */
+
+/**
+ * maps each input between the units of the compressor and the space the search is preformed in.
+ *
+ * Searchers convert their bounds to the search space with to_search, evaluate using the function
+ * returned by wrap, and convert the inputs they report back with from_search.
+ */
+class pressio_search_transform {
+  public:
+  /** the functions that can be applied to an input */
+  enum class kind {
+    /** search the input directly */
+    linear,
+    /** search the base 10 logarithm of the input, the input must be positive */
+    log10,
+    /** search log(x/(1-x)) of the input, the input must be in (0,1) */
+    logit,
+  };
+
+  /**
+   * reads `opt:transform` from options
+   *
+   * \param[in] options the options passed to the search plugin
+   * \param[in] name the name of the search plugin
+   * \param[out] err the reason the transform is invalid if it is
+   * \returns 0 on success, non-zero if the transform is invalid
+   */
+  int set_options(pressio_options const& options, std::string const& name, std::string& err) {
+    std::vector<std::string> tmp_names;
+    if(options.get(name, "opt:transform", &tmp_names) != pressio_options_key_set) return 0;
+    std::vector<kind> tmp_kinds;
+    for (auto const& transform_name : tmp_names) {
+      if(transform_name == "linear" || transform_name.empty()) tmp_kinds.push_back(kind::linear);
+      else if(transform_name == "log10") tmp_kinds.push_back(kind::log10);
+      else if(transform_name == "logit") tmp_kinds.push_back(kind::logit);
+      else {
+        err = "unknown transform: " + transform_name;
+        return 1;
+      }
+    }
+    transform_names = std::move(tmp_names);
+    kinds = std::move(tmp_kinds);
+    return 0;
+  }
+
+  /** \returns the names of the transforms as provided by the user */
+  std::vector<std::string> const& names() const {
+    return transform_names;
+  }
+
+  /** \returns true if every input is searched directly */
+  bool is_linear() const {
+    return std::all_of(std::begin(kinds), std::end(kinds), [](kind k){ return k == kind::linear; });
+  }
+
+  /**
+   * \param[in] dim the input to query
+   * \returns true if the input is searched directly
+   */
+  bool is_linear(size_t dim) const {
+    return dim >= kinds.size() || kinds[dim] == kind::linear;
+  }
+
+  /**
+   * \param[in] input inputs in the units of the compressor
+   * \returns the inputs in the search space; non-finite if the input is outside the domain of the transform
+   */
+  pressio_search_results::input_type to_search(pressio_search_results::input_type input) const {
+    for (size_t dim = 0; dim < input.size() && dim < kinds.size(); ++dim) {
+      switch(kinds[dim]) {
+        case kind::log10:
+          input[dim] = std::log10(input[dim]);
+          break;
+        case kind::logit:
+          input[dim] = std::log(input[dim] / (1.0 - input[dim]));
+          break;
+        case kind::linear:
+          break;
+      }
+    }
+    return input;
+  }
+
+  /**
+   * \param[in] input inputs in the search space
+   * \returns the inputs in the units of the compressor
+   */
+  pressio_search_results::input_type from_search(pressio_search_results::input_type input) const {
+    for (size_t dim = 0; dim < input.size() && dim < kinds.size(); ++dim) {
+      switch(kinds[dim]) {
+        case kind::log10:
+          input[dim] = std::pow(10.0, input[dim]);
+          break;
+        case kind::logit:
+          input[dim] = 1.0 / (1.0 + std::exp(-input[dim]));
+          break;
+        case kind::linear:
+          break;
+      }
+    }
+    return input;
+  }
+
+  /**
+   * \param[in] input inputs in the search space
+   * \returns true if every input is finite, i.e. the original input was within the domain of the transform
+   */
+  static bool is_valid(pressio_search_results::input_type const& input) {
+    return std::all_of(std::begin(input), std::end(input), [](double value) { return std::isfinite(value); });
+  }
+
+  /**
+   * \param[in] compress_fn a function that accepts inputs in the units of the compressor
+   * \returns a function that accepts inputs in the search space
+   */
+  std::function<pressio_search_results::output_type(pressio_search_results::input_type const&)>
+  wrap(std::function<pressio_search_results::output_type(pressio_search_results::input_type const&)> compress_fn) const {
+    if(is_linear()) return compress_fn;
+    auto const transform = *this;
+    return [transform, compress_fn](pressio_search_results::input_type const& input) {
+      return compress_fn(transform.from_search(input));
+    };
+  }
+
+  /**
+   * \param[in] evaluations evaluations in the `opt:evaluations` layout in the units of the compressor
+   * \param[in] n_inputs the number of inputs for each evaluation
+   * \returns the evaluations with their inputs in the search space
+   */
+  pressio_data evaluations_to_search(pressio_data const& evaluations, const size_t n_inputs) const {
+    const size_t width = n_inputs + 1;
+    if(is_linear() || !evaluations.has_data() || evaluations.num_dimensions() != 2 || evaluations.get_dimension(0) != width) {
+      return evaluations;
+    }
+    auto values = evaluations.to_vector<double>();
+    for (size_t i = 0; i < evaluations.get_dimension(1); ++i) {
+      auto const row = values.begin() + i * width;
+      auto const input = to_search(pressio_search_results::input_type(row, row + n_inputs));
+      std::copy(std::begin(input), std::end(input), row);
+    }
+    auto transformed = pressio_data::owning(pressio_double_dtype, evaluations.dimensions());
+    std::copy(std::begin(values), std::end(values), static_cast<double*>(transformed.data()));
+    return transformed;
+  }
+
+  private:
+  std::vector<std::string> transform_names;
+  std::vector<kind> kinds;
+};
+
+#endif /* end of include guard: PRESSIO_SEARCH_TRANSFORM_H */
@@ -0,0 +1,302 @@
+#ifndef PRESSIO_SEARCH_WARM_START_H
+#define PRESSIO_SEARCH_WARM_START_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include <libpressio_ext/cpp/data.h>
+#include <std_compat/span.h>
+#include "pressio_search_evaluations.h"
+
+/**
+ * \file
+ * \brief private helper that remembers past searches so that searches on similar data can start from them
+ */
+
+/**
+ * features of the input data used to find past searches on similar data
+ */
+struct pressio_search_features {
+  /** the dtype and number of dimensions of each input, searches are only similar if these match exactly */
+  std::string key;
+  /** for each input, the log10 of the number of elements, the minimum, the maximum, and the entropy in bits */
+  std::vector<double> values;
+
+  /** the number of values for each input */
+  static constexpr size_t width = 4;
+
+  /**
+   * \param[in] input_datas the data to compute the features of
+   * \returns the features of the data
+   */
+  static pressio_search_features compute(compat::span<const pressio_data* const> const& input_datas) {
+    pressio_search_features features;
+    std::ostringstream key;
+    for (auto const* input_data : input_datas) {
+      key << static_cast<int>(input_data->dtype()) << ':' << input_data->num_dimensions() << ';';
+      //read the values in place since the data may be large
+      pressio_data_for_each<int>(*input_data, [&features](auto begin, auto end) {
+          features.append(begin, end);
+          return 0;
+      });
+    }
+    features.key = key.str();
+    return features;
+  }
+
+  /**
+   * \param[in] lhs the features of one search
+   * \param[in] rhs the features of another search with the same key
+   * \returns a distance between the features where 0 is identical
+   */
+  static double distance(std::vector<double> const& lhs, std::vector<double> const& rhs) {
+    if(lhs.size() != rhs.size()) return std::numeric_limits<double>::infinity();
+    double distance = 0;
+    for (size_t i = 0; i + width <= lhs.size(); i += width) {
+      //differences in the range are relative to the wider range
+      const double range = std::max({lhs[i+2] - lhs[i+1], rhs[i+2] - rhs[i+1], std::numeric_limits<double>::min()});
+      distance += std::abs(lhs[i] - rhs[i]) +
+        (std::abs(lhs[i+1] - rhs[i+1]) + std::abs(lhs[i+2] - rhs[i+2])) / range +
+        std::abs(lhs[i+3] - rhs[i+3]) / 8.0;
+    }
+    return distance;
+  }
+
+  private:
+  /** appends the features of the values in [begin, end) */
+  template <class ForwardIt>
+  void append(ForwardIt begin, ForwardIt end) {
+    const size_t n = std::distance(begin, end);
+    double min = 0, max = 0;
+    if(n != 0) {
+      auto const minmax = std::minmax_element(begin, end);
+      min = static_cast<double>(*minmax.first);
+      max = static_cast<double>(*minmax.second);
+    }
+    //entropy of a 256 bin histogram of the values
+    const size_t bins = 256;
+    std::vector<size_t> histogram(bins, 0);
+    for (auto it = begin; it != end; ++it) {
+      const double offset = (max > min) ? (static_cast<double>(*it) - min) / (max - min) : 0.0;
+      ++histogram[std::min(static_cast<size_t>(offset * bins), bins - 1)];
+    }
+    double entropy = 0;
+    for (auto count : histogram) {
+      if(count == 0) continue;
+      const double p = static_cast<double>(count) / static_cast<double>(n);
+      entropy -= p * std::log2(p);
+    }
+    values.insert(std::end(values), {
+        std::log10(static_cast<double>(std::max<size_t>(n, 1))),
+        min,
+        max,
+        entropy
+        });
+  }
+};
+
+/**
+ * a library of past searches keyed by the features of their data
+ *
+ * Libraries are shared by every search in the process that uses the same path,
+ * and are saved to the path by rank 0 of MPI_COMM_WORLD after every search if it is not empty.
+ * Only the most recent max_entries_per_key searches with each key are kept.
+ */
+class pressio_search_warm_start {
+  public:
+  /** a past search */
+  struct entry {
+    /** the key of the search, including the key of the features */
+    std::string key;
+    /** the values of the features of the data */
+    std::vector<double> features;
+    /** the feasible evaluations of the search, only the objective is kept */
+    pressio_search_history history;
+  };
+
+  /** the number of searches kept for each key, older searches are dropped first */
+  static constexpr size_t max_entries_per_key = 32;
+
+  /**
+   * \param[in] path the file to load the library from and save it to, or empty to only keep it in memory
+   * \returns the library shared by every search in the process that uses path
+   */
+  static std::shared_ptr<pressio_search_warm_start> library(std::string const& path) {
+    static std::mutex libraries_mutex;
+    static std::map<std::string, std::shared_ptr<pressio_search_warm_start>> libraries;
+    std::lock_guard<std::mutex> guard(libraries_mutex);
+    auto& library = libraries[path];
+    if(!library) {
+      library = std::make_shared<pressio_search_warm_start>(path);
+    }
+    return library;
+  }
+
+  /**
+   * \param[in] path the file to load the library from and save it to, or empty to only keep it in memory
+   */
+  explicit pressio_search_warm_start(std::string path): path(std::move(path)) {
+    if(this->path.empty()) return;
+    std::ifstream in(this->path);
+    std::string line;
+    while(std::getline(in, line)) {
+      entry e;
+      if(parse(line, e)) entries.emplace_back(std::move(e));
+    }
+  }
+
+  /**
+   * records a search as the most recent, replacing a previous search with the same key and features
+   * \param[in] e the search to record
+   * \param[out] err the reason the library could not be saved if it could not
+   * \returns 0 on success, non-zero if the library could not be saved; the search is recorded in memory either way
+   */
+  int add(entry e, std::string& err) {
+    for (auto& eval : e.history) {
+      eval.second.resize(std::min<size_t>(eval.second.size(), 1));
+    }
+    const std::string key = e.key;
+    std::lock_guard<std::mutex> guard(mutex);
+    auto existing = std::find_if(std::begin(entries), std::end(entries), [&e](entry const& other) {
+        return other.key == e.key && other.features == e.features;
+    });
+    if(existing != std::end(entries)) {
+      entries.erase(existing);
+    }
+    entries.emplace_back(std::move(e));
+
+    //entries are in the order they were recorded, so drop the oldest with this key
+    size_t n_entries = std::count_if(std::begin(entries), std::end(entries), [&key](entry const& other) {
+        return other.key == key;
+    });
+    for (auto it = std::begin(entries); n_entries > max_entries_per_key && it != std::end(entries);) {
+      if(it->key == key) {
+        it = entries.erase(it);
+        --n_entries;
+      } else {
+        ++it;
+      }
+    }
+
+    if(path.empty() || !is_writer()) return 0;
+    //write a copy and replace the file so that readers never see a partial library
+    const std::string tmp_path = path + ".tmp";
+    {
+      std::ofstream out(tmp_path, std::ios::trunc);
+      for (auto const& saved : entries) {
+        format(out, saved);
+      }
+      out.close();
+      if(!out) {
+        std::remove(tmp_path.c_str());
+        err = "failed to write the warm start library " + tmp_path;
+        return 1;
+      }
+    }
+    if(std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+      std::remove(tmp_path.c_str());
+      err = "failed to replace the warm start library " + path;
+      return 1;
+    }
+    return 0;
+  }
+
+  /**
+   * \param[in] key the key of the search
+   * \param[in] features the values of the features of the data
+   * \param[in] k the maximum number of searches to return
+   * \returns up to k past searches with the same key, nearest first
+   */
+  std::vector<entry> nearest(std::string const& key, std::vector<double> const& features, size_t k) const {
+    std::vector<std::pair<double, entry const*>> ranked;
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto const& e : entries) {
+      if(e.key != key) continue;
+      ranked.emplace_back(pressio_search_features::distance(features, e.features), &e);
+    }
+    std::stable_sort(std::begin(ranked), std::end(ranked), [](std::pair<double, entry const*> const& lhs, std::pair<double, entry const*> const& rhs) {
+        return lhs.first < rhs.first;
+    });
+    std::vector<entry> matches;
+    for (size_t i = 0; i < std::min(k, ranked.size()); ++i) {
+      matches.push_back(*ranked[i].second);
+    }
+    return matches;
+  }
+
+  private:
+  /**
+   * \returns true if this process saves libraries, only rank 0 does so that ranks do not overwrite each other
+   */
+  static bool is_writer() {
+    int initialized = 0, finalized = 0;
+    MPI_Initialized(&initialized);
+    MPI_Finalized(&finalized);
+    if(!initialized || finalized) return true;
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return rank == 0;
+  }
+
+  /**
+   * writes an entry as a line of tab separated fields: the key, the features, and
+   * the number of inputs followed by the inputs and objective of each evaluation
+   */
+  static void format(std::ostream& out, entry const& e) {
+    out.precision(17);
+    out << e.key << '\t' << e.features.size();
+    for (auto value : e.features) out << ' ' << value;
+    const size_t n_inputs = (e.history.empty()) ? 0 : std::begin(e.history)->first.size();
+    const size_t n_evaluations = std::count_if(std::begin(e.history), std::end(e.history), [n_inputs](pressio_search_history::value_type const& eval) {
+        return eval.first.size() == n_inputs && !eval.second.empty();
+    });
+    out << '\t' << n_inputs << ' ' << n_evaluations;
+    for (auto const& eval : e.history) {
+      if(eval.first.size() != n_inputs || eval.second.empty()) continue;
+      for (auto input : eval.first) out << ' ' << input;
+      out << ' ' << eval.second.front();
+    }
+    out << '\n';
+  }
+
+  /** \returns true if line was a valid entry */
+  static bool parse(std::string const& line, entry& e) {
+    auto const first_tab = line.find('\t');
+    if(first_tab == std::string::npos) return false;
+    e.key = line.substr(0, first_tab);
+    std::istringstream in(line.substr(first_tab + 1));
+    size_t n_features;
+    if(!(in >> n_features)) return false;
+    e.features.resize(n_features);
+    for (auto& value : e.features) {
+      if(!(in >> value)) return false;
+    }
+    size_t n_inputs, n_evaluations;
+    if(!(in >> n_inputs >> n_evaluations)) return false;
+    for (size_t i = 0; i < n_evaluations; ++i) {
+      pressio_search_results::input_type input(n_inputs);
+      double objective;
+      for (auto& value : input) {
+        if(!(in >> value)) return false;
+      }
+      if(!(in >> objective)) return false;
+      e.history.emplace(std::move(input), pressio_search_results::output_type{objective});
+    }
+    return true;
+  }
+
+  std::string path;
+  mutable std::mutex mutex;
+  std::vector<entry> entries;
+};
+
+#endif /* end of include guard: PRESSIO_SEARCH_WARM_START_H */
@@ -0,0 +1,402 @@
+#include "pressio_search.h"
+#include "pressio_search_results.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_transform.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <std_compat/memory.h>
+
+/**
+ * probes the objective with a few evaluations along each axis, and then hands
+ * off to the search that best suits what was observed
+ */
+struct auto_search: public pressio_search_plugin {
+  public:
+    auto_search() {
+      flat_search = search_plugins().build(flat_search_str);
+      monotone_search = search_plugins().build(monotone_search_str);
+      smooth_search = search_plugins().build(smooth_search_str);
+      rugged_search = search_plugins().build(rugged_search_str);
+    }
+
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &stop_token) override {
+      pressio_search_results results;
+      selected.clear();
+      selected_role.clear();
+      if(lower_bound.empty() || lower_bound.size() != upper_bound.size()) {
+        results.status = 1;
+        results.msg = "auto was configured with lower_bound and upper_bound of different or zero sizes";
+        return results;
+      }
+      if(!pressio_search_transform::is_valid(transform.to_search(lower_bound)) ||
+         !pressio_search_transform::is_valid(transform.to_search(upper_bound))) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      pressio_search_budget budget(time_budget);
+      const size_t n_dims = lower_bound.size();
+      const size_t points_per_axis = std::max<size_t>(3, probe_points | 1);
+
+      //probe along each axis through the center of the search space
+      pressio_search_history history;
+      std::vector<std::vector<double>> axes(n_dims);
+      pressio_search_results::input_type search_center(n_dims);
+      for (size_t dim = 0; dim < n_dims; ++dim) {
+        search_center[dim] = axis_point(dim, points_per_axis/2, points_per_axis);
+      }
+      auto const center = transform.from_search(search_center);
+      auto probe = [&](pressio_search_results::input_type const& input) {
+        auto it = history.find(input);
+        if(it == history.end()) {
+          it = history.emplace(input, compress_fn(input)).first;
+        }
+        return it->second.front();
+      };
+      for (size_t dim = 0; dim < n_dims; ++dim) {
+        for (size_t j = 0; j < points_per_axis; ++j) {
+          auto search_input = search_center;
+          search_input[dim] = axis_point(dim, j, points_per_axis);
+          auto const input = transform.from_search(search_input);
+          double value = probe(input);
+          axes[dim].push_back(value);
+          if(constraints.feasible(history[input]) && is_achieved(value)) {
+            stop_token.request_stop();
+            selected_role = "probe";
+            results.inputs = input;
+            results.output = history[input];
+            return results;
+          }
+          if(stop_token.stop_requested() || budget.expired()) {
+            selected_role = "probe";
+            return best_of(history, results);
+          }
+        }
+      }
+
+      //classify the landscape
+      double min_value = std::numeric_limits<double>::max();
+      double max_value = std::numeric_limits<double>::lowest();
+      double scale = 0;
+      for (auto const& eval : history) {
+        min_value = std::min(min_value, eval.second.front());
+        max_value = std::max(max_value, eval.second.front());
+        scale = std::max(scale, std::abs(eval.second.front()));
+      }
+      const double range = max_value - min_value;
+      is_flat = range <= flat_tolerance * scale;
+
+      noise = 0;
+      if(probe_noise && !is_flat && !stop_token.stop_requested() && !budget.expired()) {
+        //costs one more compression, so it is only done when asked for
+        auto repeat = compress_fn(center);
+        noise = std::abs(repeat.front() - history[center].front()) / range;
+      }
+      const bool is_noisy = noise > noise_tolerance;
+
+      turns = 0;
+      roughness = 0;
+      for (auto const& axis : axes) {
+        int last_sign = 0;
+        size_t axis_turns = 0;
+        for (size_t j = 1; j < axis.size(); ++j) {
+          const double diff = axis[j] - axis[j-1];
+          if(std::abs(diff) <= flat_tolerance * scale) continue;
+          const int sign = (diff > 0) ? 1 : -1;
+          if(last_sign != 0 && sign != last_sign) ++axis_turns;
+          last_sign = sign;
+        }
+        turns = std::max(turns, axis_turns);
+        for (size_t j = 1; j + 1 < axis.size(); ++j) {
+          if(range > 0) {
+            roughness = std::max(roughness, std::abs(axis[j+1] - 2*axis[j] + axis[j-1]) / range);
+          }
+        }
+      }
+      const bool is_monotone = turns == 0;
+      const bool is_smooth = turns <= 1 && roughness <= smooth_tolerance;
+
+      pressio_search* child;
+      if(is_flat) {
+        selected_role = "flat";
+        selected = flat_search_str;
+        child = &flat_search;
+      } else if(n_dims == 1 && is_monotone && !is_noisy && mode == pressio_search_mode_target) {
+        selected_role = "monotone";
+        selected = monotone_search_str;
+        child = &monotone_search;
+      } else if(is_smooth && !is_noisy) {
+        selected_role = "smooth";
+        selected = smooth_search_str;
+        child = &smooth_search;
+      } else {
+        selected_role = "rugged";
+        selected = rugged_search_str;
+        child = &rugged_search;
+      }
+
+      //seed the selected search with the feasible probes
+      pressio_search_options_guard restore(*child);
+      pressio_options seed_options;
+      seed_options.set("opt:evaluations", seed_evaluations(history, constraints, n_dims, evaluations_data));
+      if(budget.limited()) {
+        seed_options.set("opt:time_budget", budget.remaining());
+      }
+      if(child == &monotone_search && target) {
+        auto const& axis = axes.front();
+        for (size_t j = 1; j < axis.size(); ++j) {
+          if((axis[j-1] - *target) * (axis[j] - *target) <= 0) {
+            const double bracket_lower = transform.from_search({axis_point(0, j-1, points_per_axis)}).front();
+            const double bracket_upper = transform.from_search({axis_point(0, j, points_per_axis)}).front();
+            seed_options.set("opt:lower_bound", pressio_data{bracket_lower});
+            seed_options.set("opt:upper_bound", pressio_data{bracket_upper});
+            seed_options.set("opt:evaluations", seed_evaluations(history, constraints, n_dims, evaluations_data, {bracket_lower}, {bracket_upper}));
+            break;
+          }
+        }
+      }
+      (*child)->set_options(seed_options);
+      results = (*child)->search(input_datas, compress_fn, stop_token);
+
+      if(results.status > 0) {
+        return results;
+      }
+      //the probes may have been better than anything the search found
+      pressio_search_results probe_results;
+      best_of(history, probe_results);
+      if(probe_results.output.empty()) {
+        return results;
+      }
+      if(results.output.empty() || !constraints.feasible(results.output)) {
+        //the search found nothing feasible, but a probe was
+        return probe_results;
+      }
+      if(is_better(probe_results.output.front(), results.output.front())) {
+        probe_results.status = results.status;
+        probe_results.msg = results.msg;
+        return probe_results;
+      }
+      return results;
+    }
+
+    //configuration
+    pressio_options get_configuration_impl() const override {
+      pressio_options opts;
+      set_meta_configuration(opts, "auto:flat_search", search_plugins(), flat_search);
+      set_meta_configuration(opts, "auto:monotone_search", search_plugins(), monotone_search);
+      set_meta_configuration(opts, "auto:smooth_search", search_plugins(), smooth_search);
+      set_meta_configuration(opts, "auto:rugged_search", search_plugins(), rugged_search);
+      return opts;
+    }
+
+    pressio_options get_options() const override {
+      pressio_options opts;
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      set(opts, "opt:target", target);
+      set(opts, "opt:objective_mode", mode);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:transform", transform.names());
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "auto:probe_points", probe_points);
+      set(opts, "auto:probe_noise", probe_noise);
+      set(opts, "auto:flat_tolerance", flat_tolerance);
+      set(opts, "auto:noise_tolerance", noise_tolerance);
+      set(opts, "auto:smooth_tolerance", smooth_tolerance);
+      set_meta(opts, "auto:flat_search", flat_search_str, flat_search);
+      set_meta(opts, "auto:monotone_search", monotone_search_str, monotone_search);
+      set_meta(opts, "auto:smooth_search", smooth_search_str, smooth_search);
+      set_meta(opts, "auto:rugged_search", rugged_search_str, rugged_search);
+      return opts;
+    }
+
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      get(options, "opt:target", &target);
+      get(options, "opt:objective_mode", &mode);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:evaluations", &evaluations_data);
+      get(options, "opt:time_budget", &time_budget);
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      get(options, "auto:probe_points", &probe_points);
+      get(options, "auto:probe_noise", &probe_noise);
+      get(options, "auto:flat_tolerance", &flat_tolerance);
+      get(options, "auto:noise_tolerance", &noise_tolerance);
+      get(options, "auto:smooth_tolerance", &smooth_tolerance);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      get_meta(options, "auto:flat_search", search_plugins(), flat_search_str, flat_search);
+      get_meta(options, "auto:monotone_search", search_plugins(), monotone_search_str, monotone_search);
+      get_meta(options, "auto:smooth_search", search_plugins(), smooth_search_str, smooth_search);
+      get_meta(options, "auto:rugged_search", search_plugins(), rugged_search_str, rugged_search);
+      return 0;
+    }
+
+    pressio_options get_metrics_results() const override {
+      pressio_options metrics;
+      if(selected_role == "flat") metrics.copy_from(flat_search->get_metrics_results());
+      else if(selected_role == "monotone") metrics.copy_from(monotone_search->get_metrics_results());
+      else if(selected_role == "smooth") metrics.copy_from(smooth_search->get_metrics_results());
+      else if(selected_role == "rugged") metrics.copy_from(rugged_search->get_metrics_results());
+      set(metrics, "auto:selected_role", selected_role);
+      set(metrics, "auto:selected_search", selected);
+      set(metrics, "auto:dimensions", static_cast<uint64_t>(lower_bound.size()));
+      set(metrics, "auto:flat", static_cast<int32_t>(is_flat));
+      set(metrics, "auto:turns", static_cast<uint64_t>(turns));
+      set(metrics, "auto:roughness", roughness);
+      set(metrics, "auto:noise", noise);
+      return metrics;
+    }
+
+    void set_name_impl(std::string const& new_name) override {
+      flat_search->set_name(new_name + "/" + flat_search->prefix());
+      monotone_search->set_name(new_name + "/" + monotone_search->prefix());
+      smooth_search->set_name(new_name + "/" + smooth_search->prefix());
+      rugged_search->set_name(new_name + "/" + rugged_search->prefix());
+    }
+
+    std::vector<std::string> children() const final override {
+        return {
+            flat_search->get_name(),
+            monotone_search->get_name(),
+            smooth_search->get_name(),
+            rugged_search->get_name(),
+        };
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "auto";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<auto_search>(*this);
+    }
+
+private:
+    /** \returns the j-th of n evenly spaced interior points along dimension dim in the search space */
+    double axis_point(size_t dim, size_t j, size_t n) const {
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      return search_lower[dim] + (static_cast<double>(j) + 0.5) / static_cast<double>(n) * (search_upper[dim] - search_lower[dim]);
+    }
+
+    /** \returns true if actual meets the target for the current mode */
+    bool is_achieved(double actual) const {
+      switch(mode) {
+        case pressio_search_mode_target:
+          return target && std::abs(actual - *target) <= std::abs(*target * global_rel_tolerance);
+        case pressio_search_mode_min:
+          return target && actual < *target;
+        case pressio_search_mode_max:
+          return target && actual > *target;
+        default:
+          return false;
+      }
+    }
+
+    /** \returns true if lhs is a better objective than rhs for the current mode */
+    bool is_better(double lhs, double rhs) const {
+      switch(mode) {
+        case pressio_search_mode_target:
+          return target && std::abs(lhs - *target) < std::abs(rhs - *target);
+        case pressio_search_mode_min:
+          return lhs < rhs;
+        case pressio_search_mode_max:
+          return lhs > rhs;
+        default:
+          return false;
+      }
+    }
+
+    /** fills results with the best feasible evaluation from history */
+    pressio_search_results& best_of(pressio_search_history const& history, pressio_search_results& results) const {
+      auto best = std::end(history);
+      for (auto it = std::begin(history); it != std::end(history); ++it) {
+        if(it->second.empty() || !constraints.feasible(it->second)) continue;
+        if(best == std::end(history) || is_better(it->second.front(), best->second.front())) best = it;
+      }
+      if(best != std::end(history)) {
+        results.inputs = best->first;
+        results.output = best->second;
+      }
+      return results;
+    }
+
+    pressio_search_results::input_type lower_bound;
+    pressio_search_results::input_type upper_bound;
+    compat::optional<pressio_search_results::output_type::value_type> target;
+    unsigned int mode = pressio_search_mode_target;
+    double global_rel_tolerance = .1;
+    pressio_data evaluations_data;
+    double time_budget = std::numeric_limits<double>::max();
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    unsigned int probe_points = 5;
+    int32_t probe_noise = 0;
+    double flat_tolerance = 1e-3;
+    double noise_tolerance = .05;
+    double smooth_tolerance = .5;
+
+    std::string flat_search_str = "random_search";
+    std::string monotone_search_str = "secant";
+    std::string smooth_search_str = "fraz";
+    std::string rugged_search_str = "fraz";
+    pressio_search flat_search;
+    pressio_search monotone_search;
+    pressio_search smooth_search;
+    pressio_search rugged_search;
+
+    //results of the last probe
+    std::string selected_role;
+    std::string selected;
+    bool is_flat = false;
+    size_t turns = 0;
+    double roughness = 0;
+    double noise = 0;
+};
+
+
+static pressio_register auto_register(search_plugins(), "auto", [](){ return compat::make_unique<auto_search>();});
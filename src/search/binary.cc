@@ -1,6 +1,11 @@
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <limits>
 #include "pressio_search.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_transform.h"
 #include <std_compat/std_compat.h>
 
 struct binary_search: public pressio_search_plugin {
@@ -10,23 +15,37 @@ struct binary_search: public pressio_search_plugin {
                                           pressio_search_results::input_type const &)> compress_fn,
                                   distributed::queue::StopToken &token) override {
       pressio_search_results results;
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
       size_t iter = 2;
-      auto lower = lower_bound.front();
-      auto upper = upper_bound.front();
+      auto lower = search_lower.front();
+      auto upper = search_upper.front();
       auto current = (upper-lower)/2.0 + lower;
       compat::optional<decltype(lower)> lower_value{};
       compat::optional<decltype(upper)> upper_value{};
       auto last_time = std::chrono::system_clock::now();
       auto max_time = std::chrono::system_clock::now() + std::chrono::seconds(max_seconds);
+      pressio_search_budget budget(time_budget);
       auto result_v = compress_fn({current});
       auto result = result_v.front();
+      auto best_input = current;
+      auto best_result_v = result_v;
+      bool best_feasible = constraints.feasible(result_v);
+      const double infeasible_direction = (constraints.monotone().empty()) ? 0.0 : constraints.monotone().front();
 
       auto is_nonmonotonic = [&]() {
         return  (lower_value && *lower_value > result) || //check for non-monotonicity on the lower bound
                 (upper_value && *upper_value < result); //check for non-monotonicity on the upper bound
       };
       auto check_global_tolerance = [&]{
-        return ((1.0-global_rel_tolerance)*target <= result && result <= (1.0+global_rel_tolerance)*target);
+        return ((1.0-global_rel_tolerance)*target <= result && result <= (1.0+global_rel_tolerance)*target) &&
+          constraints.feasible(result_v);
       };
       auto is_done = [&](){
         return 
@@ -35,11 +54,19 @@ struct binary_search: public pressio_search_plugin {
           (max_seconds > 0 && (last_time = std::chrono::system_clock::now()) > max_time) || //check for time exceeded
           (lower > upper) || //check for floating point rounding errors
           is_nonmonotonic() || //check for non-monotonic results, violation of assumptions
+          budget.expired() || //check for the time budget of the entire search
           token.stop_requested()
           ;
       };
       while(not is_done()) {
-        if(result < target) {
+        if(infeasible_direction != 0 && !constraints.feasible(result_v)) {
+          //every input beyond current in this direction is also infeasible
+          if(infeasible_direction > 0) {
+            upper = current;
+          } else {
+            lower = current;
+          }
+        } else if(result < target) {
           lower = current;
           lower_value = result;
         } else {
@@ -50,6 +77,13 @@ struct binary_search: public pressio_search_plugin {
         current = (upper-lower)/2.0 + lower;
         result_v = compress_fn({current});
         result = result_v.front();
+        const bool feasible = constraints.feasible(result_v);
+        if((feasible && !best_feasible) ||
+           (feasible == best_feasible && std::abs(result - target) < std::abs(best_result_v.front() - target))) {
+          best_input = current;
+          best_result_v = result_v;
+          best_feasible = feasible;
+        }
         ++iter;
       }
       if(check_global_tolerance()) {
@@ -63,12 +97,23 @@ struct binary_search: public pressio_search_plugin {
         results.status = -1;
         results.msg = "iterations exceeded";
       }
-      if(last_time > max_time) {
+      if(last_time > max_time || budget.expired()) {
         results.status = -2;
         results.msg = "time-limit exceeded";
       }
-      results.inputs = {current};
-      results.output = result_v;
+      if(!best_feasible) {
+        results.status = -3;
+        results.msg = "no feasible point found";
+      }
+      if(check_global_tolerance()) {
+        results.inputs = {current};
+        results.output = result_v;
+      } else {
+        //return the best so far if we stopped early
+        results.inputs = {best_input};
+        results.output = best_result_v;
+      }
+      results.inputs = transform.from_search(results.inputs);
 
       return results;
     }
@@ -79,12 +124,16 @@ struct binary_search: public pressio_search_plugin {
       
       //need to reconfigure because input size has changed
       set(opts, "opt:prediction", pressio_data(std::begin(prediction), std::end(prediction)));
-      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(prediction)));
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
       set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
       set(opts, "opt:max_iterations", max_iterations);
       set(opts, "opt:max_seconds", max_seconds);
       set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
       set(opts, "opt:target", target);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:transform", transform.names());
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
       return opts;
     }
     virtual int set_options(pressio_options const& options) override {
@@ -105,6 +154,15 @@ struct binary_search: public pressio_search_plugin {
       get(options, "opt:max_seconds", &max_seconds);
       get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
       get(options, "opt:target", &target);
+      get(options, "opt:time_budget", &time_budget);
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
       return 0;
     }
     
@@ -145,6 +203,9 @@ private:
     double global_rel_tolerance;
     unsigned int max_iterations;
     unsigned int max_seconds;
+    double time_budget = std::numeric_limits<double>::max();
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
 };
 
 
@@ -0,0 +1,535 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <thread>
+#include <time.h>
+#include "pressio_search.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_results.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_sequence.h"
+#include "pressio_search_transform.h"
+#include <std_compat/memory.h>
+
+namespace {
+  /**
+   * a Gaussian process with a Matern 5/2 kernel over inputs scaled to [0,1]
+   *
+   * the outputs are standardized, and the length scale is chosen from a small
+   * grid by maximizing the marginal likelihood
+   */
+  class gaussian_process {
+    public:
+    void fit(std::vector<std::vector<double>> const& xs, std::vector<double> const& ys) {
+      x = xs;
+      const double n = static_cast<double>(ys.size());
+      mean = 0;
+      for (auto y : ys) mean += y;
+      mean /= n;
+      double var = 0;
+      for (auto y : ys) var += (y - mean) * (y - mean);
+      scale = std::sqrt(var / n);
+      if(!(scale > 0)) scale = 1;
+      y.resize(ys.size());
+      std::transform(std::begin(ys), std::end(ys), std::begin(y), [this](double value) { return (value - mean) / scale; });
+
+      double best_likelihood = std::numeric_limits<double>::lowest();
+      double best_length = length_scales.front();
+      for (auto candidate : length_scales) {
+        double likelihood;
+        if(factor(candidate, likelihood) && likelihood > best_likelihood) {
+          best_likelihood = likelihood;
+          best_length = candidate;
+        }
+      }
+      double likelihood;
+      factor(best_length, likelihood);
+    }
+
+    /** adds an observation without refitting the length scale in O(n^2), used for fantasies */
+    void add(std::vector<double> const& xi, double yi) {
+      x.push_back(xi);
+      y.push_back((yi - mean) / scale);
+      if(!append_row(x.size() - 1)) {
+        double likelihood;
+        factor(length, likelihood);
+        return;
+      }
+      solve();
+    }
+
+    void predict(std::vector<double> const& xi, double& mu, double& sigma) const {
+      //only the observations in the factor are used, which is all of them unless every jitter failed
+      const size_t n = L.size();
+      std::vector<double> k(n);
+      for (size_t i = 0; i < n; ++i) k[i] = kernel(x[i], xi);
+      double m = 0;
+      for (size_t i = 0; i < n; ++i) m += k[i] * alpha[i];
+      //v = L^-1 k
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < i; ++j) k[i] -= L[i][j] * k[j];
+        k[i] /= L[i][i];
+      }
+      double var = 1.0;
+      for (size_t i = 0; i < n; ++i) var -= k[i] * k[i];
+      mu = m * scale + mean;
+      sigma = std::sqrt(std::max(var, 1e-12)) * scale;
+    }
+
+    private:
+    double kernel(std::vector<double> const& lhs, std::vector<double> const& rhs) const {
+      double d2 = 0;
+      for (size_t i = 0; i < lhs.size(); ++i) d2 += (lhs[i] - rhs[i]) * (lhs[i] - rhs[i]);
+      const double r = std::sqrt(5.0 * d2) / length;
+      return (1.0 + r + r * r / 3.0) * std::exp(-r);
+    }
+
+    /**
+     * computes the Cholesky factor and weights for a length scale
+     *
+     * nearly duplicate observations, such as those rounded to the same integer, make the kernel
+     * matrix singular, so the jitter added to the diagonal is increased tenfold until it factors
+     *
+     * \returns false if it is not positive definite with the largest jitter
+     */
+    bool factor(double candidate_length, double& likelihood) {
+      length = candidate_length;
+      for (jitter = noise; ; jitter = std::min(jitter * 10, max_jitter)) {
+        L.clear();
+        size_t i = 0;
+        while(i < x.size() && append_row(i)) ++i;
+        if(i == x.size()) {
+          solve();
+          likelihood = likelihood_term;
+          return true;
+        }
+        if(jitter >= max_jitter) break;
+      }
+      solve();
+      return false;
+    }
+
+    /** appends the row of the Cholesky factor for observation i, \returns false if it is not positive definite */
+    bool append_row(size_t i) {
+      std::vector<double> row(i + 1);
+      for (size_t j = 0; j <= i; ++j) {
+        double sum = kernel(x[i], x[j]) + ((i == j) ? jitter : 0.0);
+        std::vector<double> const& other = (i == j) ? row : L[j];
+        for (size_t k = 0; k < j; ++k) sum -= row[k] * other[k];
+        if(i == j) {
+          if(sum <= 0) return false;
+          row[i] = std::sqrt(sum);
+        } else {
+          row[j] = sum / L[j][j];
+        }
+      }
+      L.push_back(std::move(row));
+      return true;
+    }
+
+    /** computes alpha = L^-T L^-1 y and the log marginal likelihood */
+    void solve() {
+      const size_t n = L.size();
+      alpha = y;
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < i; ++j) alpha[i] -= L[i][j] * alpha[j];
+        alpha[i] /= L[i][i];
+      }
+      likelihood_term = 0;
+      for (size_t i = 0; i < n; ++i) likelihood_term -= 0.5 * alpha[i] * alpha[i] + std::log(L[i][i]);
+      for (size_t i = n; i > 0; --i) {
+        for (size_t j = i; j < n; ++j) alpha[i-1] -= L[j][i-1] * alpha[j];
+        alpha[i-1] /= L[i-1][i-1];
+      }
+    }
+
+    const std::vector<double> length_scales{.05, .1, .2, .4, .8, 1.6};
+    const double noise = 1e-6;
+    const double max_jitter = 1.0;
+    //the noise added to the diagonal of the kernel matrix for the current factor
+    double jitter = noise;
+    std::vector<std::vector<double>> x;
+    std::vector<double> y;
+    //the rows of the lower triangular Cholesky factor of the kernel matrix
+    std::vector<std::vector<double>> L;
+    std::vector<double> alpha;
+    double likelihood_term = 0;
+    double mean = 0;
+    double scale = 1;
+    double length = .2;
+  };
+
+  double normal_pdf(double z) {
+    return std::exp(-0.5 * z * z) / std::sqrt(2.0 * std::acos(-1.0));
+  }
+  double normal_cdf(double z) {
+    return 0.5 * std::erfc(-z / std::sqrt(2.0));
+  }
+
+  /**
+   * \returns the expected improvement of N(mu, sigma) over best for the mode;
+   * for target mode best is the smallest distance to the target seen so far
+   */
+  double expected_improvement(double mu, double sigma, double best, unsigned int mode, double target) {
+    switch(mode) {
+      case pressio_search_mode_min:
+        {
+          const double z = (best - mu) / sigma;
+          return (best - mu) * normal_cdf(z) + sigma * normal_pdf(z);
+        }
+      case pressio_search_mode_max:
+        {
+          const double z = (mu - best) / sigma;
+          return (mu - best) * normal_cdf(z) + sigma * normal_pdf(z);
+        }
+      case pressio_search_mode_target:
+      default:
+        {
+          //integrate best - |y - target| over target-best < y < target+best
+          auto piece = [mu, sigma](double lower, double upper, double a, double b) {
+            //integral of (a + b*y) N(y; mu, sigma) from lower to upper
+            const double zl = (lower - mu) / sigma, zu = (upper - mu) / sigma;
+            const double mass = normal_cdf(zu) - normal_cdf(zl);
+            return a * mass + b * (mu * mass + sigma * (normal_pdf(zl) - normal_pdf(zu)));
+          };
+          return piece(target - best, target, best - target, 1.0) +
+                 piece(target, target + best, best + target, -1.0);
+        }
+    }
+  }
+}
+
+/**
+ * Bayesian optimization using a Gaussian process and expected improvement.
+ *
+ * Each round proposes as many points as there are threads using the kriging
+ * believer heuristic: after each proposal the model is updated as if the point
+ * returned its predicted mean, and the next point maximizes expected improvement
+ * over the updated model.
+ */
+struct bo_search: public pressio_search_plugin {
+  public:
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &token) override {
+      pressio_search_results results;
+      if(mode == pressio_search_mode_target && not target) {
+        results.status = 1;
+        results.msg = "bo requires opt:target in target mode";
+        return results;
+      }
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
+      const size_t n_dims = search_lower.size();
+      auto last_time = std::chrono::system_clock::now();
+      auto max_time = std::chrono::system_clock::now() + std::chrono::seconds(max_seconds);
+      pressio_search_budget budget(time_budget);
+      pressio_search_feasibility feasibility(constraints);
+
+      //observations in [0,1]^n_dims
+      auto to_unit = [&](pressio_search_results::input_type const& input) {
+        std::vector<double> unit(n_dims);
+        for (size_t dim = 0; dim < n_dims; ++dim) {
+          const double width = search_upper[dim] - search_lower[dim];
+          unit[dim] = (width > 0) ? (input[dim] - search_lower[dim]) / width : 0.0;
+        }
+        return unit;
+      };
+      auto from_unit = [&](std::vector<double> const& unit) {
+        pressio_search_results::input_type input(n_dims);
+        for (size_t dim = 0; dim < n_dims; ++dim) {
+          input[dim] = search_lower[dim] + unit[dim] * (search_upper[dim] - search_lower[dim]);
+          if(dim < is_integral.size() && is_integral[dim] && transform.is_linear(dim)) {
+            input[dim] = std::min(std::max(std::round(input[dim]), std::ceil(search_lower[dim])), std::floor(search_upper[dim]));
+          }
+        }
+        return input;
+      };
+      std::vector<std::vector<double>> xs;
+      std::vector<double> ys;
+      try {
+        auto const prior = evaluations_to_history(transform.evaluations_to_search(evaluations_data, n_dims), n_dims);
+        for (auto const& eval : prior) {
+          xs.push_back(to_unit(eval.first));
+          ys.push_back(eval.second.front());
+        }
+      } catch(std::runtime_error const& err) {
+        results.status = -1;
+        results.msg = err.what();
+        return results;
+      }
+
+      compat::optional<pressio_search_results::input_type> best_input;
+      pressio_search_results::output_type best_output;
+      auto objective = [this](double value) {
+        return (mode == pressio_search_mode_target) ? std::abs(value - *target) : value;
+      };
+      auto is_better = [this](double lhs, double rhs) {
+        return (mode == pressio_search_mode_max) ? lhs > rhs : lhs < rhs;
+      };
+      const pressio_search_objective goal(mode, target, global_rel_tolerance);
+      for (size_t i = 0; i < ys.size(); ++i) {
+        //prior evaluations only contain the objective, so they are assumed feasible if there are no constraints
+        if(constraints.empty() && (not best_input || is_better(objective(ys[i]), objective(best_output.front())))) {
+          best_input = from_unit(xs[i]);
+          best_output = {ys[i]};
+        }
+      }
+      bool done = best_input && goal.is_achieved(best_output.front());
+      size_t iter = 0;
+      auto is_stopped = [&]() {
+        return (iter >= max_iterations) ||
+          (max_seconds > 0 && (last_time = std::chrono::system_clock::now()) > max_time) ||
+          budget.expired() ||
+          token.stop_requested();
+      };
+
+      std::mt19937_64 gen(seed.value_or(time(nullptr)));
+      const size_t batch = std::max(1u, (thread_safe) ? nthreads : 1u);
+      const pressio_search_sequence design(pressio_search_sequence::kind::sobol,
+          std::min(n_dims, pressio_search_sequence::max_dims(pressio_search_sequence::kind::sobol)),
+          max_iterations, gen(), true);
+      uint64_t design_index = 0;
+      auto design_point = [&]() {
+        auto unit = design.point(design_index++);
+        //dimensions beyond those supported by sobol are sampled uniformly
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        while(unit.size() < n_dims) unit.push_back(dist(gen));
+        return unit;
+      };
+
+      gaussian_process gp;
+      std::vector<std::vector<double>> proposals;
+      std::vector<pressio_search_results::output_type> outputs;
+      std::vector<std::exception_ptr> errors;
+      while(!done && !is_stopped()) {
+        //propose a batch of points
+        proposals.clear();
+        const size_t n_proposals = std::min<size_t>(batch, max_iterations - iter);
+        const bool use_model = xs.size() >= std::max<size_t>(initial_points, 2);
+        if(use_model) gp.fit(xs, ys);
+        for (size_t p = 0; p < n_proposals; ++p) {
+          if(!use_model) {
+            proposals.push_back(design_point());
+            continue;
+          }
+          double best_objective = std::numeric_limits<double>::max();
+          if(mode == pressio_search_mode_max) best_objective = std::numeric_limits<double>::lowest();
+          for (auto y : ys) {
+            if(is_better(objective(y), best_objective)) best_objective = objective(y);
+          }
+          std::vector<double> best_candidate;
+          double best_ei = -1;
+          auto consider = [&](std::vector<double> candidate) {
+            for (auto& value : candidate) value = std::min(std::max(value, 0.0), 1.0);
+            if(feasibility.pruned(from_unit(candidate))) return;
+            double mu, sigma;
+            gp.predict(candidate, mu, sigma);
+            const double ei = expected_improvement(mu, sigma, best_objective, mode, (target) ? *target : 0.0);
+            if(ei > best_ei) {
+              best_ei = ei;
+              best_candidate = std::move(candidate);
+            }
+          };
+          //explore globally and refine around the best observation
+          for (size_t c = 0; c < candidates; ++c) consider(design_point());
+          size_t best_idx = 0;
+          for (size_t i = 1; i < ys.size(); ++i) {
+            if(is_better(objective(ys[i]), objective(ys[best_idx]))) best_idx = i;
+          }
+          std::normal_distribution<double> step(0.0, 0.05);
+          for (size_t c = 0; c < candidates; ++c) {
+            auto candidate = xs[best_idx];
+            for (auto& value : candidate) value += step(gen);
+            consider(std::move(candidate));
+          }
+          if(best_candidate.empty()) best_candidate = design_point();
+          //pretend the proposal returned its mean so the next proposal goes elsewhere
+          double mu, sigma;
+          gp.predict(best_candidate, mu, sigma);
+          gp.add(best_candidate, mu);
+          proposals.push_back(std::move(best_candidate));
+        }
+
+        //evaluate the batch
+        outputs.assign(proposals.size(), {});
+        errors.assign(proposals.size(), nullptr);
+        std::vector<pressio_search_results::input_type> inputs;
+        std::transform(std::begin(proposals), std::end(proposals), std::back_inserter(inputs), from_unit);
+        auto evaluate = [&](size_t i) {
+          try {
+            if(!feasibility.pruned(inputs[i])) {
+              outputs[i] = compress_fn(inputs[i]);
+              feasibility.record(inputs[i], outputs[i]);
+            }
+          } catch(...) {
+            errors[i] = std::current_exception();
+          }
+        };
+        if(thread_safe && proposals.size() > 1) {
+          std::vector<std::thread> threads;
+          for (size_t i = 0; i < proposals.size(); ++i) threads.emplace_back(evaluate, i);
+          for (auto& thread : threads) thread.join();
+        } else {
+          for (size_t i = 0; i < proposals.size(); ++i) evaluate(i);
+        }
+        for (auto const& error : errors) {
+          if(error) std::rethrow_exception(error);
+        }
+        iter += proposals.size();
+
+        for (size_t i = 0; i < proposals.size(); ++i) {
+          if(outputs[i].empty()) continue;
+          xs.push_back(to_unit(inputs[i]));
+          ys.push_back(outputs[i].front());
+          if(!constraints.feasible(outputs[i])) continue;
+          if(not best_input || is_better(objective(outputs[i].front()), objective(best_output.front()))) {
+            best_input = inputs[i];
+            best_output = outputs[i];
+          }
+        }
+        done = best_input && goal.is_achieved(best_output.front());
+      }
+
+      if(done) {
+        token.request_stop();
+      } else if(iter >= max_iterations) {
+        results.status = -1;
+        results.msg = "iterations exceeded";
+      } else if(last_time > max_time || budget.expired()) {
+        results.status = -2;
+        results.msg = "time-limit exceeded";
+      }
+      if(best_input) {
+        results.inputs = transform.from_search(*best_input);
+        results.output = best_output;
+      } else {
+        results.status = -3;
+        results.msg = "no feasible point found";
+      }
+      return results;
+    }
+
+    //configuration
+    pressio_options get_options() const override {
+      pressio_options opts;
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      std::vector<uint8_t> is_integral_u8(is_integral.begin(), is_integral.end());
+      set(opts, "opt:is_integral", pressio_data(std::begin(is_integral_u8), std::end(is_integral_u8)));
+      set(opts, "opt:max_iterations", max_iterations);
+      set(opts, "opt:max_seconds", max_seconds);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:target", target);
+      set(opts, "opt:objective_mode", mode);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "opt:transform", transform.names());
+      set(opts, "bo:nthreads", nthreads);
+      set(opts, "bo:initial_points", initial_points);
+      set(opts, "bo:candidates", candidates);
+      set(opts, "bo:seed", seed);
+      return opts;
+    }
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:is_integral", &data) == pressio_options_key_set) {
+        auto is_integral_u8 = data.to_vector<uint8_t>();
+        is_integral = std::vector<bool>(is_integral_u8.begin(), is_integral_u8.end());
+      }
+      get(options, "opt:max_iterations", &max_iterations);
+      get(options, "opt:max_seconds", &max_seconds);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:target", &target);
+      get(options, "opt:objective_mode", &mode);
+      get(options, "opt:evaluations", &evaluations_data);
+      get(options, "opt:time_budget", &time_budget);
+      get(options, "opt:thread_safe", &thread_safe);
+      get(options, "bo:nthreads", &nthreads);
+      get(options, "bo:initial_points", &initial_points);
+      get(options, "bo:candidates", &candidates);
+      get(options, "bo:seed", &seed);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      return 0;
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "bo";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<bo_search>(*this);
+    }
+
+private:
+    pressio_search_results::input_type lower_bound{};
+    pressio_search_results::input_type upper_bound{};
+    std::vector<bool> is_integral{};
+    compat::optional<pressio_search_results::output_type::value_type> target{};
+    pressio_data evaluations_data;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    double global_rel_tolerance = .1;
+    unsigned int max_iterations = 100;
+    unsigned int max_seconds = 0;
+    double time_budget = std::numeric_limits<double>::max();
+    unsigned int mode = pressio_search_mode_target;
+    unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int initial_points = 5;
+    unsigned int candidates = 256;
+    compat::optional<unsigned int> seed;
+    int thread_safe = 0;
+};
+
+
+static pressio_register bo_register(search_plugins(), "bo", [](){ return compat::make_unique<bo_search>();});
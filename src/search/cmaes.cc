@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <time.h>
+#include "pressio_search.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_results.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_transform.h"
+#include <std_compat/memory.h>
+
+namespace {
+  /**
+   * computes the eigen decomposition of a symmetric matrix using cyclic Jacobi rotations
+   *
+   * \param[in,out] a a row-major n by n symmetric matrix, destroyed on output
+   * \param[out] eigenvectors the eigenvectors as the columns of a row-major matrix
+   * \param[out] eigenvalues the eigenvalues
+   */
+  void symmetric_eigen(std::vector<double>& a, size_t n, std::vector<double>& eigenvectors, std::vector<double>& eigenvalues) {
+    eigenvectors.assign(n * n, 0.0);
+    for (size_t i = 0; i < n; ++i) eigenvectors[i*n+i] = 1.0;
+    for (size_t sweep = 0; sweep < 50; ++sweep) {
+      double off = 0;
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) off += a[i*n+j] * a[i*n+j];
+      }
+      if(off < 1e-30) break;
+      for (size_t p = 0; p < n; ++p) {
+        for (size_t q = p + 1; q < n; ++q) {
+          if(std::abs(a[p*n+q]) < 1e-300) continue;
+          const double theta = (a[q*n+q] - a[p*n+p]) / (2.0 * a[p*n+q]);
+          const double t = ((theta >= 0) ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+          const double c = 1.0 / std::sqrt(t * t + 1.0), s = t * c;
+          for (size_t k = 0; k < n; ++k) {
+            const double akp = a[k*n+p], akq = a[k*n+q];
+            a[k*n+p] = c * akp - s * akq;
+            a[k*n+q] = s * akp + c * akq;
+          }
+          for (size_t k = 0; k < n; ++k) {
+            const double apk = a[p*n+k], aqk = a[q*n+k];
+            a[p*n+k] = c * apk - s * aqk;
+            a[q*n+k] = s * apk + c * aqk;
+          }
+          for (size_t k = 0; k < n; ++k) {
+            const double vkp = eigenvectors[k*n+p], vkq = eigenvectors[k*n+q];
+            eigenvectors[k*n+p] = c * vkp - s * vkq;
+            eigenvectors[k*n+q] = s * vkp + c * vkq;
+          }
+        }
+      }
+    }
+    eigenvalues.resize(n);
+    for (size_t i = 0; i < n; ++i) eigenvalues[i] = a[i*n+i];
+  }
+}
+
+/**
+ * the covariance matrix adaptation evolution strategy with increasing population restarts (IPOP-CMA-ES).
+ *
+ * Each generation is evaluated concurrently, and the search restarts from a random point with
+ * twice the population when the step size collapses or the best value stops improving.
+ */
+struct cmaes_search: public pressio_search_plugin {
+  public:
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &token) override {
+      pressio_search_results results;
+      if(mode == pressio_search_mode_target && not target) {
+        results.status = 1;
+        results.msg = "cmaes requires opt:target in target mode";
+        return results;
+      }
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
+      const size_t n = search_lower.size();
+      auto last_time = std::chrono::system_clock::now();
+      auto max_time = std::chrono::system_clock::now() + std::chrono::seconds(max_seconds);
+      pressio_search_budget budget(time_budget);
+      pressio_search_feasibility feasibility(constraints);
+
+      //the search is performed in [0,1]^n so that a single step size suits every input
+      auto from_unit = [&](std::vector<double> const& unit) {
+        pressio_search_results::input_type input(n);
+        for (size_t dim = 0; dim < n; ++dim) {
+          input[dim] = search_lower[dim] + std::min(std::max(unit[dim], 0.0), 1.0) * (search_upper[dim] - search_lower[dim]);
+        }
+        return input;
+      };
+      const pressio_search_objective goal(mode, target, global_rel_tolerance);
+
+      std::mt19937_64 gen(seed.value_or(time(nullptr)));
+      std::uniform_real_distribution<double> uniform(0.0, 1.0);
+      std::normal_distribution<double> normal(0.0, 1.0);
+
+      //start the first run from the best prior evaluation if there is one
+      std::vector<double> mean(n, 0.5);
+      try {
+        auto const prior = evaluations_to_history(transform.evaluations_to_search(evaluations_data, n), n);
+        double best_prior = std::numeric_limits<double>::max();
+        for (auto const& eval : prior) {
+          if(goal.loss(eval.second) < best_prior) {
+            best_prior = goal.loss(eval.second);
+            for (size_t dim = 0; dim < n; ++dim) {
+              const double width = search_upper[dim] - search_lower[dim];
+              mean[dim] = (width > 0) ? std::min(std::max((eval.first[dim] - search_lower[dim]) / width, 0.0), 1.0) : 0.0;
+            }
+          }
+        }
+      } catch(std::runtime_error const& err) {
+        results.status = -1;
+        results.msg = err.what();
+        return results;
+      }
+
+      compat::optional<pressio_search_results::input_type> best_input;
+      pressio_search_results::output_type best_output;
+      size_t evaluations = 0;
+      bool done = false;
+      auto is_stopped = [&]() {
+        return done || (evaluations >= max_iterations) ||
+          (max_seconds > 0 && (last_time = std::chrono::system_clock::now()) > max_time) ||
+          budget.expired() ||
+          token.stop_requested();
+      };
+
+      //use at least the default population, rounded up to a multiple of the threads so none are idle
+      const size_t workers = (thread_safe) ? std::max(1u, nthreads) : 1;
+      size_t lambda = std::max<size_t>(4 + static_cast<size_t>(3 * std::log(static_cast<double>(n))), population);
+      lambda = ((lambda + workers - 1) / workers) * workers;
+      for (size_t restart = 0; !is_stopped(); ++restart, lambda *= 2) {
+        //strategy parameters from Hansen's tutorial
+        const size_t mu = lambda / 2;
+        std::vector<double> weights(mu);
+        for (size_t i = 0; i < mu; ++i) weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+        const double weight_sum = std::accumulate(std::begin(weights), std::end(weights), 0.0);
+        for (auto& w : weights) w /= weight_sum;
+        const double mueff = 1.0 / std::inner_product(std::begin(weights), std::end(weights), std::begin(weights), 0.0);
+        const double nd = static_cast<double>(n);
+        const double cc = (4.0 + mueff / nd) / (nd + 4.0 + 2.0 * mueff / nd);
+        const double cs = (mueff + 2.0) / (nd + mueff + 5.0);
+        const double c1 = 2.0 / ((nd + 1.3) * (nd + 1.3) + mueff);
+        const double cmu = std::min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) / ((nd + 2.0) * (nd + 2.0) + mueff));
+        const double damps = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff - 1.0) / (nd + 1.0)) - 1.0) + cs;
+        const double chin = std::sqrt(nd) * (1.0 - 1.0 / (4.0 * nd) + 1.0 / (21.0 * nd * nd));
+
+        if(restart > 0) {
+          for (auto& value : mean) value = uniform(gen);
+        }
+        double sigma = initial_sigma;
+        std::vector<double> pc(n, 0.0), ps(n, 0.0);
+        std::vector<double> C(n * n, 0.0), B(n * n, 0.0), D(n, 1.0);
+        for (size_t i = 0; i < n; ++i) C[i*n+i] = B[i*n+i] = 1.0;
+        double run_best = std::numeric_limits<double>::infinity();
+        size_t stalled = 0;
+
+        std::vector<std::vector<double>> zs(lambda, std::vector<double>(n)), ys(lambda, std::vector<double>(n)), xs(lambda, std::vector<double>(n));
+        std::vector<pressio_search_results::input_type> inputs(lambda);
+        std::vector<pressio_search_results::output_type> outputs(lambda);
+        std::vector<std::exception_ptr> errors(lambda);
+        std::vector<double> losses(lambda);
+        std::vector<size_t> order(lambda);
+        for (size_t generation = 0; !is_stopped(); ++generation) {
+          //sample the population x = m + sigma * B * D * z
+          for (size_t k = 0; k < lambda; ++k) {
+            for (auto& z : zs[k]) z = normal(gen);
+            for (size_t i = 0; i < n; ++i) {
+              double y = 0;
+              for (size_t j = 0; j < n; ++j) y += B[i*n+j] * D[j] * zs[k][j];
+              ys[k][i] = y;
+              xs[k][i] = mean[i] + sigma * y;
+            }
+            inputs[k] = from_unit(xs[k]);
+            outputs[k].clear();
+            errors[k] = nullptr;
+          }
+
+          const size_t n_evaluate = std::min<size_t>(lambda, max_iterations - evaluations);
+          auto evaluate = [&](size_t k) {
+            try {
+              if(!feasibility.pruned(inputs[k])) {
+                outputs[k] = compress_fn(inputs[k]);
+                feasibility.record(inputs[k], outputs[k]);
+              }
+            } catch(...) {
+              errors[k] = std::current_exception();
+            }
+          };
+          if(workers > 1) {
+            for (size_t first = 0; first < n_evaluate; first += workers) {
+              std::vector<std::thread> threads;
+              for (size_t k = first; k < std::min(first + workers, n_evaluate); ++k) {
+                threads.emplace_back(evaluate, k);
+              }
+              for (auto& thread : threads) {
+                thread.join();
+              }
+            }
+          } else {
+            for (size_t k = 0; k < n_evaluate; ++k) {
+              evaluate(k);
+            }
+          }
+          for (auto const& error : errors) {
+            if(error) std::rethrow_exception(error);
+          }
+          evaluations += n_evaluate;
+
+          for (size_t k = 0; k < lambda; ++k) {
+            const bool feasible = !outputs[k].empty() && constraints.feasible(outputs[k]);
+            losses[k] = feasible ? goal.loss(outputs[k]) : std::numeric_limits<double>::infinity();
+            if(feasible && (not best_input || losses[k] < goal.loss(best_output))) {
+              best_input = inputs[k];
+              best_output = outputs[k];
+              done = done || goal.is_achieved(outputs[k].front());
+            }
+          }
+          if(n_evaluate < lambda || done) break;
+
+          //recombine the best mu points, points outside the bounds are repaired to the points evaluated
+          std::iota(std::begin(order), std::end(order), 0);
+          std::sort(std::begin(order), std::end(order), [&](size_t lhs, size_t rhs) { return losses[lhs] < losses[rhs]; });
+          std::vector<double> old_mean = mean;
+          for (size_t k = 0; k < lambda; ++k) {
+            for (size_t i = 0; i < n; ++i) {
+              xs[k][i] = std::min(std::max(xs[k][i], 0.0), 1.0);
+              ys[k][i] = (xs[k][i] - old_mean[i]) / sigma;
+            }
+          }
+          std::fill(std::begin(mean), std::end(mean), 0.0);
+          for (size_t r = 0; r < mu; ++r) {
+            for (size_t i = 0; i < n; ++i) mean[i] += weights[r] * xs[order[r]][i];
+          }
+          std::vector<double> step(n);
+          for (size_t i = 0; i < n; ++i) step[i] = (mean[i] - old_mean[i]) / sigma;
+
+          //ps uses C^-1/2 * step = B * D^-1 * B^T * step
+          std::vector<double> bt_step(n, 0.0), c_inv_sqrt_step(n, 0.0);
+          for (size_t j = 0; j < n; ++j) {
+            for (size_t i = 0; i < n; ++i) bt_step[j] += B[i*n+j] * step[i];
+            bt_step[j] /= D[j];
+          }
+          for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) c_inv_sqrt_step[i] += B[i*n+j] * bt_step[j];
+          }
+          double ps_norm = 0;
+          for (size_t i = 0; i < n; ++i) {
+            ps[i] = (1.0 - cs) * ps[i] + std::sqrt(cs * (2.0 - cs) * mueff) * c_inv_sqrt_step[i];
+            ps_norm += ps[i] * ps[i];
+          }
+          ps_norm = std::sqrt(ps_norm);
+          const bool hsig = ps_norm / std::sqrt(1.0 - std::pow(1.0 - cs, 2.0 * (generation + 1))) / chin < 1.4 + 2.0 / (nd + 1.0);
+          for (size_t i = 0; i < n; ++i) {
+            pc[i] = (1.0 - cc) * pc[i] + (hsig ? std::sqrt(cc * (2.0 - cc) * mueff) : 0.0) * step[i];
+          }
+          for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+              double rank_mu = 0;
+              for (size_t r = 0; r < mu; ++r) rank_mu += weights[r] * ys[order[r]][i] * ys[order[r]][j];
+              const double value = (1.0 - c1 - cmu) * C[i*n+j] +
+                c1 * (pc[i] * pc[j] + (hsig ? 0.0 : cc * (2.0 - cc) * C[i*n+j])) +
+                cmu * rank_mu;
+              C[i*n+j] = C[j*n+i] = value;
+            }
+          }
+          sigma *= std::exp((cs / damps) * (ps_norm / chin - 1.0));
+
+          std::vector<double> work = C;
+          symmetric_eigen(work, n, B, D);
+          double max_d = 0;
+          for (auto& d : D) {
+            d = std::sqrt(std::max(d, 1e-20));
+            max_d = std::max(max_d, d);
+          }
+
+          //restart when the search has converged or stopped improving
+          if(losses[order.front()] < run_best) {
+            run_best = losses[order.front()];
+            stalled = 0;
+          } else {
+            ++stalled;
+          }
+          if(sigma * max_d < tolerance || stalled >= stall_generations || !std::isfinite(sigma)) {
+            break;
+          }
+        }
+      }
+
+      if(done) {
+        token.request_stop();
+      } else if(evaluations >= max_iterations) {
+        results.status = -1;
+        results.msg = "iterations exceeded";
+      } else if(last_time > max_time || budget.expired()) {
+        results.status = -2;
+        results.msg = "time-limit exceeded";
+      }
+      if(best_input) {
+        results.inputs = transform.from_search(*best_input);
+        results.output = best_output;
+      } else {
+        results.status = -3;
+        results.msg = "no feasible point found";
+      }
+      return results;
+    }
+
+    //configuration
+    pressio_options get_options() const override {
+      pressio_options opts;
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      set(opts, "opt:max_iterations", max_iterations);
+      set(opts, "opt:max_seconds", max_seconds);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:target", target);
+      set(opts, "opt:objective_mode", mode);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "opt:transform", transform.names());
+      set(opts, "cmaes:nthreads", nthreads);
+      set(opts, "cmaes:population", population);
+      set(opts, "cmaes:sigma", initial_sigma);
+      set(opts, "cmaes:tolerance", tolerance);
+      set(opts, "cmaes:stall_generations", stall_generations);
+      set(opts, "cmaes:seed", seed);
+      return opts;
+    }
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      get(options, "opt:max_iterations", &max_iterations);
+      get(options, "opt:max_seconds", &max_seconds);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:target", &target);
+      get(options, "opt:objective_mode", &mode);
+      get(options, "opt:evaluations", &evaluations_data);
+      get(options, "opt:time_budget", &time_budget);
+      get(options, "opt:thread_safe", &thread_safe);
+      get(options, "cmaes:nthreads", &nthreads);
+      get(options, "cmaes:population", &population);
+      double tmp_sigma;
+      if(get(options, "cmaes:sigma", &tmp_sigma) == pressio_options_key_set) {
+        if(!(tmp_sigma > 0)) return set_error(1, "cmaes:sigma must be positive");
+        initial_sigma = tmp_sigma;
+      }
+      get(options, "cmaes:tolerance", &tolerance);
+      get(options, "cmaes:stall_generations", &stall_generations);
+      get(options, "cmaes:seed", &seed);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      return 0;
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "cmaes";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<cmaes_search>(*this);
+    }
+
+private:
+    pressio_search_results::input_type lower_bound{};
+    pressio_search_results::input_type upper_bound{};
+    compat::optional<pressio_search_results::output_type::value_type> target{};
+    pressio_data evaluations_data;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    double global_rel_tolerance = .1;
+    unsigned int max_iterations = 100;
+    unsigned int max_seconds = 0;
+    double time_budget = std::numeric_limits<double>::max();
+    unsigned int mode = pressio_search_mode_target;
+    unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int population = 0;
+    double initial_sigma = .3;
+    double tolerance = 1e-6;
+    unsigned int stall_generations = 20;
+    compat::optional<unsigned int> seed;
+    int thread_safe = 0;
+};
+
+
+static pressio_register cmaes_register(search_plugins(), "cmaes", [](){ return compat::make_unique<cmaes_search>();});
@@ -0,0 +1,376 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include "pressio_search.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_results.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_transform.h"
+#include <std_compat/memory.h>
+
+/**
+ * coordinate descent using a bracketing line search along each input in turn.
+ *
+ * Each sweep searches every input once from the current point: a step is taken in the direction
+ * that improves, doubled until the objective worsens, and the resulting bracket is narrowed by a
+ * golden section search.  The step of each input is carried over to the next sweep, growing to the
+ * distance it last moved or halving when it did not move.  Inputs declared independent in
+ * `coordinate:independent` are searched concurrently from the same point and their moves combined.
+ */
+struct coordinate_search: public pressio_search_plugin {
+  public:
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &token) override {
+      pressio_search_results results;
+      if(mode == pressio_search_mode_target && not target) {
+        results.status = 1;
+        results.msg = "coordinate requires opt:target in target mode";
+        return results;
+      }
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
+      const size_t n_dims = search_lower.size();
+      pressio_search_budget budget(time_budget);
+      const pressio_search_objective goal(mode, target, global_rel_tolerance);
+      const pressio_search_unit_cube cube(search_lower, search_upper, is_integral, transform);
+
+      pressio_search_history priors;
+      try {
+        priors = evaluations_to_history(transform.evaluations_to_search(evaluations_data, n_dims), n_dims);
+      } catch(std::runtime_error const& err) {
+        results.status = -1;
+        results.msg = err.what();
+        return results;
+      }
+      //start from the prediction, then the best prior evaluation, then the center
+      std::vector<double> current(n_dims, .5);
+      if(prediction.size() == n_dims) {
+        current = cube.to_unit(transform.to_search(prediction));
+      } else if(!priors.empty()) {
+        auto best_prior = std::min_element(std::begin(priors), std::end(priors), [&](pressio_search_history::value_type const& lhs, pressio_search_history::value_type const& rhs) {
+            return goal.loss(lhs.second) < goal.loss(rhs.second);
+        });
+        current = cube.to_unit(best_prior->first);
+      }
+      //prior evaluations only contain the objective, so they are only reused if there are no constraints
+      if(!constraints.empty()) {
+        priors.clear();
+      }
+
+      pressio_search_incumbent incumbent(compress_fn, goal, constraints, cube, std::move(priors),
+          max_iterations, max_seconds, budget, token);
+      std::mutex mutex;
+
+      auto min_step = [&](size_t dim) {
+        return cube.min_step(dim, tolerance);
+      };
+      //the best position found along one input, and if the search should stop
+      struct line_result {
+        double position;
+        double value;
+        bool stopped;
+      };
+      //searches along dim from origin, which has the loss origin_value, starting with a step of step
+      auto line_search = [&](size_t dim, std::vector<double> const& origin, double origin_value, double step) {
+        line_result best{origin[dim], origin_value, false};
+        auto probe = [&](double position, double& value) {
+          auto point = origin;
+          point[dim] = std::min(std::max(position, 0.0), 1.0);
+          point = cube.to_unit(cube.from_unit(point));
+          if(!incumbent.evaluate(point, value)) {
+            best.stopped = true;
+            return false;
+          }
+          if(value < best.value) {
+            best.position = point[dim];
+            best.value = value;
+          }
+          return true;
+        };
+
+        //find a bracket a < b < c around the best position with f(b) <= f(a), f(c)
+        double a = origin[dim] - step, b = origin[dim], c = origin[dim] + step;
+        double fa = std::numeric_limits<double>::infinity(), fb = origin_value, fc = std::numeric_limits<double>::infinity();
+        if(c <= 1.0) {
+          if(!probe(c, fc)) return best;
+        }
+        if(fc < fb) {
+          //expand upward, doubling the step each time
+          while(fc < fb && c < 1.0) {
+            const double next = std::min(c + 2.0 * (c - b), 1.0);
+            a = b; fa = fb;
+            b = c; fb = fc;
+            c = next;
+            if(!probe(c, fc)) return best;
+          }
+        } else {
+          if(a >= 0.0) {
+            if(!probe(a, fa)) return best;
+          }
+          //expand downward, doubling the step each time
+          while(fa < fb && a > 0.0) {
+            const double next = std::max(a - 2.0 * (b - a), 0.0);
+            c = b; fc = fb;
+            b = a; fb = fa;
+            a = next;
+            if(!probe(a, fa)) return best;
+          }
+        }
+        a = std::max(a, 0.0);
+        c = std::min(c, 1.0);
+
+        //narrow the bracket with a golden section search
+        const double golden = (3.0 - std::sqrt(5.0)) / 2.0;
+        for (unsigned int i = 0; i < line_iterations && (c - a) > min_step(dim); ++i) {
+          const bool upper = (c - b) > (b - a);
+          const double x = upper ? b + golden * (c - b) : b - golden * (b - a);
+          double fx;
+          if(!probe(x, fx)) return best;
+          if(fx < fb) {
+            if(upper) a = b; else c = b;
+            b = x; fb = fx;
+          } else {
+            if(upper) c = x; else a = x;
+          }
+        }
+        return best;
+      };
+
+      std::vector<size_t> independent_dims, dependent_dims;
+      for (size_t dim = 0; dim < n_dims; ++dim) {
+        if(dim < independent.size() && independent[dim]) independent_dims.push_back(dim);
+        else dependent_dims.push_back(dim);
+      }
+      std::vector<double> step(n_dims, initial_step);
+      //the step for the next sweep is the distance the input last moved, or half the step if it did not move
+      auto update_step = [&](size_t dim, double moved) {
+        step[dim] = (moved > 0) ? std::min(std::max(moved, min_step(dim)), .5) : step[dim] / 2.0;
+      };
+      auto is_active = [&](size_t dim) {
+        return step[dim] >= min_step(dim);
+      };
+
+      double current_value;
+      sweeps = 0;
+      bool stopped = !incumbent.evaluate(current, current_value);
+      while(!stopped) {
+        bool any_active = false;
+        for (size_t dim = 0; dim < n_dims; ++dim) any_active = any_active || is_active(dim);
+        if(!any_active) break;
+        ++sweeps;
+
+        //independent inputs are searched concurrently from the same point
+        std::vector<size_t> parallel_dims;
+        std::copy_if(std::begin(independent_dims), std::end(independent_dims), std::back_inserter(parallel_dims), is_active);
+        if(!parallel_dims.empty()) {
+          std::vector<line_result> lines(parallel_dims.size(), line_result{0, 0, false});
+          size_t next_dim = 0;
+          auto worker = [&]() {
+            while(true) {
+              size_t i;
+              {
+                std::lock_guard<std::mutex> guard(mutex);
+                if(next_dim >= parallel_dims.size()) return;
+                i = next_dim++;
+              }
+              const size_t dim = parallel_dims[i];
+              lines[i] = line_search(dim, current, current_value, step[dim]);
+            }
+          };
+          const size_t n_workers = (thread_safe) ? std::min<size_t>(std::max(1u, nthreads), parallel_dims.size()) : 1;
+          pressio_search_run_workers(n_workers, worker, [&incumbent]() { incumbent.stop(); });
+
+          //combine the moves, which for separable inputs improve independently
+          auto combined = current;
+          size_t best_line = 0;
+          size_t n_improved = 0;
+          for (size_t i = 0; i < parallel_dims.size(); ++i) {
+            stopped = stopped || lines[i].stopped;
+            if(lines[i].value < current_value) {
+              combined[parallel_dims[i]] = lines[i].position;
+              ++n_improved;
+              if(n_improved == 1 || lines[i].value < lines[best_line].value) best_line = i;
+            }
+          }
+          auto previous = current;
+          if(n_improved == 1 || (n_improved > 1 && stopped)) {
+            current[parallel_dims[best_line]] = lines[best_line].position;
+            current_value = lines[best_line].value;
+          } else if(n_improved > 1) {
+            double combined_value;
+            stopped = !incumbent.evaluate(combined, combined_value);
+            if(!stopped && combined_value <= lines[best_line].value) {
+              //the inputs were separable, take every move
+              current = combined;
+              current_value = combined_value;
+            } else {
+              //the inputs interact, only take the best move
+              current[parallel_dims[best_line]] = lines[best_line].position;
+              current_value = lines[best_line].value;
+            }
+          }
+          for (auto dim : parallel_dims) {
+            update_step(dim, std::abs(current[dim] - previous[dim]));
+          }
+        }
+
+        //dependent inputs are searched one at a time
+        for (size_t i = 0; i < dependent_dims.size() && !stopped; ++i) {
+          const size_t dim = dependent_dims[i];
+          if(!is_active(dim)) continue;
+          auto const line = line_search(dim, current, current_value, step[dim]);
+          stopped = line.stopped;
+          const double moved = (line.value < current_value) ? std::abs(line.position - current[dim]) : 0.0;
+          if(line.value < current_value) {
+            current[dim] = line.position;
+            current_value = line.value;
+          }
+          update_step(dim, moved);
+        }
+      }
+
+      return incumbent.results(transform);
+    }
+
+    //configuration
+    pressio_options get_options() const override {
+      pressio_options opts;
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      std::vector<uint8_t> is_integral_u8(is_integral.begin(), is_integral.end());
+      set(opts, "opt:is_integral", pressio_data(std::begin(is_integral_u8), std::end(is_integral_u8)));
+      set(opts, "opt:prediction", pressio_data(std::begin(prediction), std::end(prediction)));
+      set(opts, "opt:max_iterations", max_iterations);
+      set(opts, "opt:max_seconds", max_seconds);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:target", target);
+      set(opts, "opt:objective_mode", mode);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "opt:transform", transform.names());
+      std::vector<uint8_t> independent_u8(independent.begin(), independent.end());
+      set(opts, "coordinate:independent", pressio_data(std::begin(independent_u8), std::end(independent_u8)));
+      set(opts, "coordinate:nthreads", nthreads);
+      set(opts, "coordinate:initial_step", initial_step);
+      set(opts, "coordinate:tolerance", tolerance);
+      set(opts, "coordinate:line_iterations", line_iterations);
+      return opts;
+    }
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:is_integral", &data) == pressio_options_key_set) {
+        auto is_integral_u8 = data.to_vector<uint8_t>();
+        is_integral = std::vector<bool>(is_integral_u8.begin(), is_integral_u8.end());
+      }
+      if(get(options, "opt:prediction", &data) == pressio_options_key_set) {
+        prediction = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      get(options, "opt:max_iterations", &max_iterations);
+      get(options, "opt:max_seconds", &max_seconds);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:target", &target);
+      get(options, "opt:objective_mode", &mode);
+      get(options, "opt:evaluations", &evaluations_data);
+      get(options, "opt:time_budget", &time_budget);
+      get(options, "opt:thread_safe", &thread_safe);
+      if(get(options, "coordinate:independent", &data) == pressio_options_key_set) {
+        auto independent_u8 = data.to_vector<uint8_t>();
+        independent = std::vector<bool>(independent_u8.begin(), independent_u8.end());
+      }
+      get(options, "coordinate:nthreads", &nthreads);
+      get(options, "coordinate:initial_step", &initial_step);
+      get(options, "coordinate:tolerance", &tolerance);
+      get(options, "coordinate:line_iterations", &line_iterations);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      return 0;
+    }
+
+    pressio_options get_metrics_results() const override {
+      pressio_options metrics;
+      set(metrics, "coordinate:sweeps", sweeps);
+      return metrics;
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "coordinate";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<coordinate_search>(*this);
+    }
+
+private:
+    pressio_search_results::input_type lower_bound{};
+    pressio_search_results::input_type upper_bound{};
+    std::vector<bool> is_integral{};
+    pressio_search_results::input_type prediction{};
+    compat::optional<pressio_search_results::output_type::value_type> target{};
+    pressio_data evaluations_data;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    double global_rel_tolerance = .1;
+    unsigned int max_iterations = 100;
+    unsigned int max_seconds = 0;
+    double time_budget = std::numeric_limits<double>::max();
+    unsigned int mode = pressio_search_mode_target;
+    std::vector<bool> independent{};
+    unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+    double initial_step = .25;
+    double tolerance = 1e-4;
+    unsigned int line_iterations = 8;
+    uint32_t sweeps = 0;
+    int thread_safe = 0;
+};
+
+
+static pressio_register coordinate_register(search_plugins(), "coordinate", [](){ return compat::make_unique<coordinate_search>();});
@@ -1,6 +1,10 @@
 #include "pressio_search.h"
 #include "pressio_search_results.h"
 #include "pressio_search_defines.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_transform.h"
 #include <cmath>
 #include <libdistributed_work_queue.h>
 #include <std_compat/memory.h>
@@ -54,14 +58,25 @@ struct dist_gridsearch_search: public pressio_search_plugin {
         best_results.status = 1;
         best_results.msg = "dist_gridsearch was configured with lower_bounds, upper_bounds, or num_bins of different sizes";
         return best_results;
+      } else if(!pressio_search_transform::is_valid(transform.to_search(lower_bound)) ||
+                !pressio_search_transform::is_valid(transform.to_search(upper_bound))) {
+        best_results.status = 1;
+        best_results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return best_results;
       }
 
       auto tasks = build_task_list();
+      pressio_search_budget budget(time_budget);
+      //evaluations made by the sub-searches on this rank, handed to the later sub-searches whose bins contain them
+      pressio_search_cache cache(compress_fn);
+      const size_t n_tasks = tasks.size();
+      const size_t n_workers = std::max(1, manager.comm_size() - 1);
+      pressio_search_evaluations_guard restore(search_method, evaluations_data);
 
       manager.
         work_queue(
           std::begin(tasks), std::end(tasks),
-          [this, &input_datas,compress_fn](
+          [this, &input_datas, &cache, &budget, n_tasks, n_workers](
             task_request_t const& task,
             distributed::queue::TaskManager<task_request_t, MPI_Comm>& task_manager) {
             //set lower and upper bounds
@@ -72,21 +87,28 @@ struct dist_gridsearch_search: public pressio_search_plugin {
             options.set("opt:lower_bound", pressio_data(std::begin(grid_lower), std::end(grid_lower)));
             options.set("opt:upper_bound", pressio_data(std::begin(grid_upper), std::end(grid_upper)));
             options.set("distributed:comm", (void*)task_manager.get_subcommunicator());
+            options.set("opt:evaluations", seed_evaluations(cache.history(), constraints, lower_bound.size(), evaluations_data, grid_lower, grid_upper));
+            if(budget.limited()) {
+              //tasks are handed out in order, so split the remaining budget
+              //over the rounds of tasks that each worker has left
+              const size_t remaining_tasks = n_tasks - std::get<2>(task);
+              options.set("opt:time_budget", budget.share((remaining_tasks + n_workers - 1) / n_workers));
+            }
             search_method->set_options(options);
 
-            if(task_manager.stop_requested()) {
+            if(task_manager.stop_requested() || budget.expired()) {
               return task_response_t{std::vector<double>{}, 1, std::vector<double>{}};
             } else {
-              auto grid_result = search_method->search(input_datas, compress_fn, task_manager);
+              auto grid_result = search_method->search(input_datas, std::ref(cache), task_manager);
               return task_response_t{grid_result.output, grid_result.status, grid_result.inputs};
             }
           },
-          [this, &best_results,&best_objective,&stop_token](task_response_t response,
+          [this, &best_results,&best_objective,&stop_token,&budget](task_response_t response,
             distributed::queue::TaskManager<task_request_t, MPI_Comm>& task_manager
             ) {
             auto const& status = std::get<1>(response);
             auto const& inputs = std::get<2>(response);
-            if(status == 0 && std::get<0>(response).size() >= 1) {
+            if(status == 0 && std::get<0>(response).size() >= 1 && constraints.feasible(std::get<0>(response))) {
               auto const& actual = std::get<0>(response).front();
               switch(mode){
                 case pressio_search_mode_max:
@@ -125,10 +147,14 @@ struct dist_gridsearch_search: public pressio_search_plugin {
                   break;
               }
             }
-            if(stop_token.stop_requested()) {
+            if(stop_token.stop_requested() || budget.expired()) {
               task_manager.request_stop();
             }
           });
+      if(!constraints.empty() && best_results.output.empty()) {
+        best_results.status = -3;
+        best_results.msg = "no feasible point found";
+      }
       manager.bcast(best_results.inputs);
       manager.bcast(best_results.output);
       manager.bcast(best_results.status);
@@ -147,6 +173,11 @@ struct dist_gridsearch_search: public pressio_search_plugin {
       set(opts, "dist_gridsearch:overlap_percentage", pressio_data(std::begin(overlap_percentage), std::end(overlap_percentage)));
       set(opts, "opt:target", target);
       set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:transform", transform.names());
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
       opts.copy_from(manager.get_options());
       set_meta(opts, "dist_gridsearch:search", search_method_str, search_method);
       set(opts, "opt:objective_mode", mode);
@@ -178,6 +209,16 @@ struct dist_gridsearch_search: public pressio_search_plugin {
       manager.set_options(options);
       get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
       get(options, "opt:objective_mode", &mode);
+      get(options, "opt:time_budget", &time_budget);
+      get(options, "opt:evaluations", &evaluations_data);
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
       get_meta(options, "dist_gridsearch:search", search_plugins(), search_method_str, search_method);
       return 0;
     }
@@ -211,42 +252,50 @@ struct dist_gridsearch_search: public pressio_search_plugin {
       return compat::make_unique<dist_gridsearch_search>(*this);
     }
 
+    pressio_options get_metrics_results() const override {
+      return search_method->get_metrics_results();
+    }
+
     void set_name_impl(std::string const& new_name) override {
       search_method->set_name(new_name + "/" + search_method->prefix());
       manager.set_name(new_name);
     }
 
 private:
-    using task_request_t = std::tuple<std::vector<double>, std::vector<double>>; //<0>=lower_bound, <1>=upper_bound
+    using task_request_t = std::tuple<std::vector<double>, std::vector<double>, size_t>; //<0>=lower_bound, <1>=upper_bound, <2>=task index
     using task_response_t  = std::tuple<std::vector<double>, int, std::vector<double>>; //<0> multi-objective <1> status <2> best_input
 
 
-    std::vector<task_request_t> build_task_list() {
+    std::vector<task_request_t> build_task_list() const {
       std::vector<task_request_t> tasks;
-      std::vector<double> step(lower_bound.size());
-      std::vector<double> overlap(lower_bound.size());
-      for (size_t dim = 0; dim < lower_bound.size(); ++dim) {
-        step[dim] = (upper_bound[dim] - lower_bound[dim]) / static_cast<double>(num_bins[dim]);
+      //split the bounds evenly in the search space
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      std::vector<double> step(search_lower.size());
+      std::vector<double> overlap(search_lower.size());
+      for (size_t dim = 0; dim < search_lower.size(); ++dim) {
+        step[dim] = (search_upper[dim] - search_lower[dim]) / static_cast<double>(num_bins[dim]);
         overlap[dim] = overlap_percentage[dim] * step[dim];
       }
 
       //be sure to include overlap_percentage % overlap between the bins
       //to ensure sufficient stationary points at the end point
 
-      std::vector<size_t> bin(lower_bound.size(), 0);
+      std::vector<size_t> bin(search_lower.size(), 0);
       bool done = false;
       size_t idx = 0;
       while(!done) {
 
-        std::vector<double> grid_lower(lower_bound.size());
-        std::vector<double> grid_upper(lower_bound.size());
-        for (size_t dim = 0; dim < lower_bound.size(); ++dim) {
-          grid_lower[dim] = std::max(lower_bound[dim], lower_bound[dim] + step[dim] * bin[dim] - overlap[dim]);
-          grid_upper[dim] = std::min(upper_bound[dim], lower_bound[dim] + step[dim] * static_cast<double>(bin[dim] + 1) + overlap[dim]);
+        std::vector<double> grid_lower(search_lower.size());
+        std::vector<double> grid_upper(search_lower.size());
+        for (size_t dim = 0; dim < search_lower.size(); ++dim) {
+          grid_lower[dim] = std::max(search_lower[dim], search_lower[dim] + step[dim] * bin[dim] - overlap[dim]);
+          grid_upper[dim] = std::min(search_upper[dim], search_lower[dim] + step[dim] * static_cast<double>(bin[dim] + 1) + overlap[dim]);
         }
         tasks.emplace_back(
-            grid_lower,
-            grid_upper
+            transform.from_search(grid_lower),
+            transform.from_search(grid_upper),
+            tasks.size()
         );
 
         bool updating = true;
@@ -286,6 +335,10 @@ private:
     unsigned int mode = pressio_search_mode_none;
     compat::optional<pressio_search_results::output_type::value_type> target;
     double global_rel_tolerance = .1;
+    double time_budget = std::numeric_limits<double>::max();
+    pressio_data evaluations_data;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
     pressio_distributed_manager manager = pressio_distributed_manager(
         /*max_ranks_per_worker*/pressio_distributed_manager::unlimited,
         /*max_masters*/1
@@ -1,9 +1,21 @@
 #include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <exception>
 #include <limits>
+#include <memory>
+#include <mpi.h>
 #include "dlib/global_optimization/find_max_global.h"
+#include "dlib/optimization.h"
 #include "pressio_search.h"
 #include "pressio_search_defines.h"
 #include "pressio_search_results.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_mailbox.h"
+#include "pressio_search_transform.h"
 #include <std_compat/memory.h>
 
 namespace {
@@ -13,11 +25,10 @@ namespace {
       if(high < value) return high;
       return value;
     }
+    constexpr double min_objective = std::numeric_limits<double>::min() * 1e-10;
+    constexpr double max_objective = std::numeric_limits<double>::max() * 1e-10;
     auto loss(double target, double actual){
-      return clamp(pow((target-actual),2),
-          std::numeric_limits<double>::min() * 1e-10,
-          std::numeric_limits<double>::max() * 1e-10
-          );
+      return clamp(pow((target-actual),2), min_objective, max_objective);
     }
     auto vector_to_dlib(pressio_search_results::input_type const& input) {
       dlib::matrix<double,0,1> output(input.size());
@@ -62,6 +73,12 @@ namespace {
 
       return evaluations;
     }
+
+    /** the tags used for messages between ranks of a distributed search */
+    enum fraz_tag {
+      fraz_tag_evaluation = 1,
+      fraz_tag_stop = 2,
+    };
 }
 
 struct fraz_search: public pressio_search_plugin {
@@ -72,17 +89,30 @@ struct fraz_search: public pressio_search_plugin {
                                   distributed::queue::StopToken &token) override {
 
       pressio_search_results results;
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
+      pressio_search_budget budget(time_budget);
       dlib::function_evaluation best_result;
-      std::map<pressio_search_results::input_type, pressio_search_results::output_type> cache;
-      dlib::thread_pool pool((thread_safe) ? (nthreads): (1));
+      pressio_search_cache cache(compress_fn, search_lower, search_upper, cache_tolerance);
+      pressio_search_feasibility feasibility(constraints);
+      update_pool();
       std::vector<dlib::function_evaluation> evaluations;
       try{
-        evaluations = data_to_evaluations(evaluations_data, lower_bound.size());
+        evaluations = data_to_evaluations(transform.evaluations_to_search(evaluations_data, lower_bound.size()), lower_bound.size());
       } catch(std::runtime_error const& err) {
         results.msg = err.what();
         results.status = -1;
         return results;
       }
+      for (auto const& eval : evaluations) {
+        feasibility.assume_feasible(dlib_to_vector(eval.x));
+      }
 
       std::vector<bool> is_integral;
       if(is_integral_config.empty()) {
@@ -93,7 +123,15 @@ struct fraz_search: public pressio_search_plugin {
         //use the actual is_integral value
         is_integral = is_integral_config;
       }
+      for (size_t dim = 0; dim < is_integral.size(); ++dim) {
+        //integer inputs are not evenly spaced in the search space of a non-linear transform
+        if(!transform.is_linear(dim)) is_integral[dim] = false;
+      }
 
+      if(distributed && comm_size() > 1) {
+        best_result = distributed_search(search_lower, search_upper, is_integral, evaluations, cache, feasibility, budget, token);
+        return finish_search(best_result, cache, feasibility);
+      }
 
       switch(mode) {
         case pressio_search_mode_target:
@@ -110,21 +148,23 @@ struct fraz_search: public pressio_search_plugin {
               return target_achived || (inter_iteration && token.stop_requested());
             };
 
-            auto fraz = [&cache, &compress_fn, this](dlib::matrix<double,0,1> const& input){
+            auto fraz = [&cache, &feasibility, this](dlib::matrix<double,0,1> const& input){
               auto const vec = dlib_to_vector(input);
-              auto const result = compress_fn(vec);
-              cache[vec] = result;
+              //infeasible points are given the worst possible loss
+              if(feasibility.pruned(vec)) return max_objective;
+              auto const result = cache(vec);
+              if(!record(feasibility, cache, vec, result)) return max_objective;
               return loss(*target, result.front());
             };
             bool skip = false;
             best_result.y = std::numeric_limits<double>::max();
             for (auto& eval : evaluations) {
+              //cache the value
+              cache.insert(dlib_to_vector(eval.x), {eval.y});
+
               //transform to optimization domain
               eval.y = loss(*target, eval.y);
 
-              //cache the value
-              cache[dlib_to_vector(eval.x)] = {eval.y};
-
               //check if we should stop because of evaluations
               if(should_stop(eval.y)) {
                 skip = true;
@@ -138,31 +178,34 @@ struct fraz_search: public pressio_search_plugin {
 
             if(!skip) {
               best_result = dlib::find_min_global(
-                  pool,
+                  *pool,
                   fraz,
-                  vector_to_dlib(lower_bound),
-                  vector_to_dlib(upper_bound),
+                  vector_to_dlib(search_lower),
+                  vector_to_dlib(search_upper),
                   is_integral,
-                  dlib::max_function_calls(max_iterations),
-                  std::chrono::seconds(max_seconds),
+                  dlib::max_function_calls(max_iterations - refine_iterations()),
+                  budget.max_runtime(max_seconds),
                   local_tolerance,
                   evaluations,
                   dlib::stop_condition(should_stop)
                   );
+              if(!token.stop_requested()) {
+                best_result = refine(best_result, fraz, should_stop, false, search_lower, search_upper, is_integral, budget);
+              }
             }
             break;
           }
         case pressio_search_mode_max:
         case pressio_search_mode_min:
           {
-            auto fraz = [&cache, &compress_fn](dlib::matrix<double,0,1> const& input){
+            //infeasible points are given the worst possible objective
+            const double infeasible_objective = (mode == pressio_search_mode_min) ? max_objective : min_objective;
+            auto fraz = [&cache, &feasibility, infeasible_objective, this](dlib::matrix<double,0,1> const& input){
               auto const vec = dlib_to_vector(input);
-              auto const result = compress_fn(vec);
-              cache[vec] = result;
-              return clamp(result.front(),
-                std::numeric_limits<double>::min() * 1e-10,
-                std::numeric_limits<double>::max() * 1e-10
-              );
+              if(feasibility.pruned(vec)) return infeasible_objective;
+              auto const result = cache(vec);
+              if(!record(feasibility, cache, vec, result)) return infeasible_objective;
+              return clamp(result.front(), min_objective, max_objective);
             };
             if(mode == pressio_search_mode_min) {
             auto should_stop = [&token, this](double value) {
@@ -173,11 +216,11 @@ struct fraz_search: public pressio_search_plugin {
               return (inter_iteration && token.stop_requested()) || target_achived;
             };
 
-            best_result.y = std::numeric_limits<double>::lowest();
+            best_result.y = std::numeric_limits<double>::max();
             bool skip = false;
             for (auto& eval : evaluations) {
               //put the value into the cache
-              cache[dlib_to_vector(eval.x)] = {eval.y};
+              cache.insert(dlib_to_vector(eval.x), {eval.y});
 
               //check if we should stop early based just on evaluations
               if(should_stop(eval.y)) {
@@ -192,17 +235,20 @@ struct fraz_search: public pressio_search_plugin {
 
             if(!skip) {
               best_result = dlib::find_min_global(
-                  pool,
+                  *pool,
                   fraz,
-                  vector_to_dlib(lower_bound),
-                  vector_to_dlib(upper_bound),
+                  vector_to_dlib(search_lower),
+                  vector_to_dlib(search_upper),
                   is_integral,
-                  dlib::max_function_calls(max_iterations),
-                  std::chrono::seconds(max_seconds),
+                  dlib::max_function_calls(max_iterations - refine_iterations()),
+                  budget.max_runtime(max_seconds),
                   local_tolerance,
                   evaluations,
                   dlib::stop_condition(should_stop)
                   );
+              if(!token.stop_requested()) {
+                best_result = refine(best_result, fraz, should_stop, false, search_lower, search_upper, is_integral, budget);
+              }
             }
             } else {
             auto should_stop = [&token, this](double value) {
@@ -212,12 +258,12 @@ struct fraz_search: public pressio_search_plugin {
               }
               return (inter_iteration && token.stop_requested())|| target_achived;
             };
-            best_result.y = std::numeric_limits<double>::max();
+            best_result.y = std::numeric_limits<double>::lowest();
             bool skip = false;
 
             for (auto& eval : evaluations) {
               //put the value into the cache
-              cache[dlib_to_vector(eval.x)] = {eval.y};
+              cache.insert(dlib_to_vector(eval.x), {eval.y});
 
               //check if we should stop early based just on evaluations
               if(should_stop(eval.y)) {
@@ -232,28 +278,35 @@ struct fraz_search: public pressio_search_plugin {
 
             if(!skip) {
               best_result = dlib::find_max_global(
-                  pool,
+                  *pool,
                   fraz,
-                  vector_to_dlib(lower_bound),
-                  vector_to_dlib(upper_bound),
+                  vector_to_dlib(search_lower),
+                  vector_to_dlib(search_upper),
                   is_integral,
-                  dlib::max_function_calls(max_iterations),
-                  std::chrono::seconds(max_seconds),
+                  dlib::max_function_calls(max_iterations - refine_iterations()),
+                  budget.max_runtime(max_seconds),
                   local_tolerance,
                   evaluations,
                   dlib::stop_condition(should_stop)
                   );
+                if(!token.stop_requested()) {
+                  best_result = refine(best_result, fraz, should_stop, true, search_lower, search_upper, is_integral, budget);
+                }
               }
             }
             break;
           }
       }
 
-      results.inputs = dlib_to_vector(best_result.x);
-      results.output = cache[results.inputs];
-      results.status = 0;
+      return finish_search(best_result, cache, feasibility);
+    }
 
-      return results;
+    pressio_options get_metrics_results() const override {
+      pressio_options metrics;
+      set(metrics, "fraz:cache_hits", cache_hits);
+      set(metrics, "fraz:cache_coalesced", cache_coalesced);
+      set(metrics, "fraz:cache_misses", cache_misses);
+      return metrics;
     }
 
     //configuration
@@ -274,8 +327,16 @@ struct fraz_search: public pressio_search_plugin {
       set(opts, "opt:target", target);
       set(opts, "opt:objective_mode", mode);
       set(opts, "fraz:nthreads", nthreads);
+      set(opts, "fraz:cache_tolerance", cache_tolerance);
+      set(opts, "fraz:distributed", distributed);
+      set(opts, "fraz:refine_fraction", refine_fraction);
+      set(opts, "fraz:refine_radius", refine_radius);
       set(opts, "opt:evaluations", evaluations_data);
       set(opts, "opt:inter_iteration", inter_iteration);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:transform", transform.names());
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
       return opts;
     }
     int set_options(pressio_options const& options) override {
@@ -300,9 +361,37 @@ struct fraz_search: public pressio_search_plugin {
       get(options, "opt:target", &target);
       get(options, "opt:thread_safe", &thread_safe);
       get(options, "fraz:nthreads", &nthreads);
+      get(options, "fraz:cache_tolerance", &cache_tolerance);
+      get(options, "fraz:distributed", &distributed);
+      double tmp_refine_fraction;
+      if(get(options, "fraz:refine_fraction", &tmp_refine_fraction) == pressio_options_key_set) {
+        if(!(tmp_refine_fraction >= 0 && tmp_refine_fraction < 1)) return set_error(1, "fraz:refine_fraction must be in [0,1)");
+        refine_fraction = tmp_refine_fraction;
+      }
+      double tmp_refine_radius;
+      if(get(options, "fraz:refine_radius", &tmp_refine_radius) == pressio_options_key_set) {
+        if(!(tmp_refine_radius > 0)) return set_error(1, "fraz:refine_radius must be positive");
+        refine_radius = tmp_refine_radius;
+      }
+      void* comm_ptr = nullptr;
+      if(get(options, "distributed:mpi_comm", &comm_ptr) == pressio_options_key_set && comm_ptr != nullptr) {
+        comm = (MPI_Comm)comm_ptr;
+      }
+      if(get(options, "distributed:comm", &comm_ptr) == pressio_options_key_set && comm_ptr != nullptr) {
+        comm = (MPI_Comm)comm_ptr;
+      }
       get(options, "opt:objective_mode", &mode);
       get(options, "opt:evaluations", &evaluations_data);
       get(options, "opt:inter_iteration", &inter_iteration);
+      get(options, "opt:time_budget", &time_budget);
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
 
       return 0;
     }
@@ -333,24 +422,360 @@ struct fraz_search: public pressio_search_plugin {
     int patch_version() const override { return 2; }
 
     std::shared_ptr<pressio_search_plugin> clone() override {
-      return compat::make_unique<fraz_search>(*this);
+      auto cloned = compat::make_unique<fraz_search>(*this);
+      //clones may search concurrently, so each starts its own pool when it first searches
+      cloned->pool.reset();
+      return cloned;
     }
 
 private:
+    /**
+     * records the feasibility of the outputs the cache returned for input
+     *
+     * with a cache tolerance the outputs may belong to another point in the cell of input,
+     * such as a prior evaluation that only carries the objective
+     */
+    static bool record(pressio_search_feasibility& feasibility, pressio_search_cache const& cache,
+        pressio_search_results::input_type const& input, pressio_search_results::output_type const& output) {
+      auto const evaluation = cache.find_evaluation(input);
+      return feasibility.record((evaluation) ? evaluation->first : input, output);
+    }
+
+    /** fills the results from the best evaluation, which must be in the search space */
+    pressio_search_results finish_search(dlib::function_evaluation const& best_result, pressio_search_cache const& cache,
+        pressio_search_feasibility const& feasibility) {
+      pressio_search_results results;
+      results.inputs = dlib_to_vector(best_result.x);
+      //with a cache tolerance the output belongs to the point evaluated for the cell of the best point
+      auto const best_evaluation = cache.find_evaluation(results.inputs);
+      if(best_evaluation) {
+        results.inputs = best_evaluation->first;
+        results.output = best_evaluation->second;
+      }
+      cache_hits = cache.hits();
+      cache_coalesced = cache.coalesced();
+      cache_misses = cache.misses();
+      const bool feasible = feasibility.feasible(results.inputs, results.output);
+      results.inputs = transform.from_search(results.inputs);
+      results.status = 0;
+      if(!feasible) {
+        results.status = -3;
+        results.msg = "no feasible point found";
+      }
+
+      return results;
+    }
+
+    int comm_size() const {
+      int size;
+      MPI_Comm_size(comm, &size);
+      return size;
+    }
+
+    /**
+     * every rank of comm searches the same bounds and sends each evaluation it makes to the
+     * other ranks without waiting for them, so each rank proposes points using the evaluations
+     * of every rank that have arrived so far.
+     *
+     * dlib's global_function_search cannot add evaluations that it did not request, so it is
+     * rebuilt from all of the evaluations whenever evaluations arrive from other ranks.
+     *
+     * \returns the best evaluation found by any rank, with its output in the cache
+     */
+    dlib::function_evaluation distributed_search(
+        pressio_search_results::input_type const& search_lower,
+        pressio_search_results::input_type const& search_upper,
+        std::vector<bool> const& is_integral,
+        std::vector<dlib::function_evaluation> const& priors,
+        pressio_search_cache& cache,
+        pressio_search_feasibility& feasibility,
+        pressio_search_budget const& budget,
+        distributed::queue::StopToken& token) {
+      pressio_search_mailbox mailbox(comm);
+      const int rank = mailbox.rank(), size = mailbox.size();
+      const size_t n_dims = search_lower.size();
+      //each rank makes its share of the evaluations
+      const size_t max_evaluations = (max_iterations + size - 1) / size;
+      const auto deadline = std::chrono::steady_clock::now() + budget.max_runtime(max_seconds);
+
+      //global_function_search maximizes, so the objective is negated for target and min modes
+      const double sign = (mode == pressio_search_mode_max) ? 1.0 : -1.0;
+      const double infeasible_score = -max_objective;
+      auto objective = [this](double value) {
+        return (mode == pressio_search_mode_target) ? loss(*target, value) : clamp(value, min_objective, max_objective);
+      };
+      const pressio_search_objective goal(mode, target, global_rel_tolerance);
+      auto in_bounds = [&](pressio_search_results::input_type const& input) {
+        if(input.size() != n_dims) return false;
+        for (size_t dim = 0; dim < n_dims; ++dim) {
+          if(input[dim] < search_lower[dim] || input[dim] > search_upper[dim]) return false;
+        }
+        return true;
+      };
+
+      std::vector<dlib::function_evaluation> shared_evaluations;
+      dlib::function_evaluation best;
+      best.y = std::numeric_limits<double>::lowest();
+      bool done = false;
+      bool stop_received = false;
+      bool rebuild = true;
+      //adds an evaluation made by any rank to the shared evaluations and returns its score
+      auto add = [&](pressio_search_results::input_type const& input, pressio_search_results::output_type const& output) {
+        cache.insert(input, output);
+        const bool feasible = feasibility.record(input, output);
+        const double score = (feasible) ? sign * objective(output.front()) : infeasible_score;
+        shared_evaluations.emplace_back(vector_to_dlib(input), score);
+        if(feasible && score > best.y) {
+          best = shared_evaluations.back();
+          done = done || goal.is_achieved(output.front());
+        }
+        return score;
+      };
+      auto receive = [&](int tag, std::vector<double> const& message) {
+        switch(tag) {
+          case fraz_tag_stop:
+            stop_received = true;
+            break;
+          case fraz_tag_evaluation:
+            {
+              //the inputs are followed by the outputs
+              if(message.size() <= n_dims) break;
+              pressio_search_results::input_type input(std::begin(message), std::begin(message) + n_dims);
+              if(!in_bounds(input)) break;
+              add(input, pressio_search_results::output_type(std::begin(message) + n_dims, std::end(message)));
+              rebuild = true;
+            }
+            break;
+        }
+      };
+
+      for (auto const& eval : priors) {
+        auto const input = dlib_to_vector(eval.x);
+        if(in_bounds(input)) add(input, {eval.y});
+      }
+
+      const dlib::function_spec spec(vector_to_dlib(search_lower), vector_to_dlib(search_upper), is_integral);
+      std::unique_ptr<dlib::global_function_search> optimizer;
+      size_t n_rebuilds = 0;
+      size_t evaluations = 0;
+      auto is_stopped = [&]() {
+        return done || stop_received || evaluations >= max_evaluations ||
+          std::chrono::steady_clock::now() >= deadline ||
+          (inter_iteration && token.stop_requested());
+      };
+      while(!is_stopped()) {
+        if(rebuild) {
+          optimizer = compat::make_unique<dlib::global_function_search>(
+              std::vector<dlib::function_spec>{spec},
+              std::vector<std::vector<dlib::function_evaluation>>{shared_evaluations});
+          optimizer->set_solver_epsilon(local_tolerance);
+          //use a different random stream on each rank and after each rebuild
+          optimizer->set_seed(static_cast<time_t>(n_rebuilds++ * size + rank));
+          rebuild = false;
+        }
+
+        //evaluate a batch of points on the threads of the pool
+        const size_t count = std::min<size_t>(pool->num_threads_in_pool(), max_evaluations - evaluations);
+        std::vector<dlib::function_evaluation_request> requests;
+        std::vector<pressio_search_results::input_type> inputs(count);
+        std::vector<pressio_search_results::output_type> outputs(count);
+        std::vector<std::exception_ptr> errors(count);
+        for (size_t i = 0; i < count; ++i) {
+          requests.emplace_back(optimizer->get_next_x());
+          inputs[i] = dlib_to_vector(requests.back().x());
+        }
+        for (size_t i = 0; i < count; ++i) {
+          pool->add_task_by_value([&, i]() {
+            try {
+              if(!feasibility.pruned(inputs[i])) outputs[i] = cache(inputs[i]);
+            } catch(...) {
+              errors[i] = std::current_exception();
+            }
+          });
+        }
+        pool->wait_for_all_tasks();
+        for (size_t i = 0; i < count; ++i) {
+          if(errors[i]) std::rethrow_exception(errors[i]);
+        }
+        evaluations += count;
+
+        for (size_t i = 0; i < count; ++i) {
+          if(outputs[i].empty()) {
+            //pruned points were not evaluated, so there is nothing to share
+            requests[i].set(infeasible_score);
+            shared_evaluations.emplace_back(vector_to_dlib(inputs[i]), infeasible_score);
+            continue;
+          }
+          requests[i].set(add(inputs[i], outputs[i]));
+          std::vector<double> message(inputs[i]);
+          message.insert(std::end(message), std::begin(outputs[i]), std::end(outputs[i]));
+          for (int other = 0; other < size; ++other) {
+            if(other != rank) mailbox.send(message, other, fraz_tag_evaluation);
+          }
+        }
+        mailbox.poll(receive);
+      }
+      if(done) {
+        //tell the other ranks to stop searching
+        for (int other = 0; other < size; ++other) {
+          if(other != rank) mailbox.send({}, other, fraz_tag_stop);
+        }
+      }
+      mailbox.drain(receive);
+      if(done || stop_received) token.request_stop();
+
+      //messages may still have been in flight, so share the best point of the best rank
+      const int best_rank = mailbox.best_rank((best.x.size()) ? -best.y : std::numeric_limits<double>::infinity());
+      std::vector<double> best_input(dlib_to_vector(best.x));
+      std::vector<double> best_output;
+      if(best_input.size()) {
+        auto const evaluation = cache.find_evaluation(best_input);
+        if(evaluation) {
+          best_input = evaluation->first;
+          best_output = evaluation->second;
+        }
+      }
+      mailbox.bcast(best_input, best_rank);
+      mailbox.bcast(best_output, best_rank);
+      if(!best_input.empty() && !best_output.empty()) {
+        cache.insert(best_input, best_output);
+      }
+      return dlib::function_evaluation(vector_to_dlib(best_input), 0.0);
+    }
+
+    /** thrown by the objective of refine to end the local search early */
+    struct refine_stop {};
+
+    /**
+     * polishes best_result with a derivative-free trust-region search (BOBYQA, or a bracketing
+     * line search when there is only one input) starting from best_result
+     *
+     * \param[in] best_result the incumbent from the global search
+     * \param[in] objective the objective used by the global search
+     * \param[in] should_stop the stop condition used by the global search
+     * \param[in] maximize true if the objective should be maximized
+     * \returns the best of best_result and the points evaluated during the refinement
+     */
+    template <class Objective, class ShouldStop>
+    dlib::function_evaluation refine(
+        dlib::function_evaluation const& best_result,
+        Objective&& objective,
+        ShouldStop&& should_stop,
+        bool maximize,
+        pressio_search_results::input_type const& search_lower,
+        pressio_search_results::input_type const& search_upper,
+        std::vector<bool> const& is_integral,
+        pressio_search_budget const& budget) const {
+      const size_t n_dims = search_lower.size();
+      const long max_evaluations = refine_iterations();
+      if(max_evaluations <= 0 || static_cast<size_t>(best_result.x.size()) != n_dims) return best_result;
+      for (size_t dim = 0; dim < n_dims; ++dim) {
+        if(!(search_upper[dim] > search_lower[dim])) return best_result;
+      }
+      const auto deadline = std::chrono::steady_clock::now() + budget.max_runtime(max_seconds);
+
+      //the refinement works in the unit cube so that every input has the same scale
+      auto from_unit = [&](dlib::matrix<double,0,1> const& unit) {
+        dlib::matrix<double,0,1> input(n_dims);
+        for (size_t dim = 0; dim < n_dims; ++dim) {
+          input(dim) = search_lower[dim] + clamp(unit(dim), 0.0, 1.0) * (search_upper[dim] - search_lower[dim]);
+          if(dim < is_integral.size() && is_integral[dim]) {
+            input(dim) = std::min(std::max(std::round(input(dim)), std::ceil(search_lower[dim])), std::floor(search_upper[dim]));
+          }
+        }
+        return input;
+      };
+      dlib::matrix<double,0,1> start(n_dims);
+      for (size_t dim = 0; dim < n_dims; ++dim) {
+        start(dim) = clamp((best_result.x(dim) - search_lower[dim]) / (search_upper[dim] - search_lower[dim]), 0.0, 1.0);
+      }
+
+      dlib::function_evaluation best = best_result;
+      long evaluations = 0;
+      auto unit_objective = [&](dlib::matrix<double,0,1> const& unit) {
+        if(evaluations >= max_evaluations || std::chrono::steady_clock::now() >= deadline) throw refine_stop{};
+        ++evaluations;
+        auto const input = from_unit(unit);
+        const double value = objective(input);
+        if((maximize) ? (value > best.y) : (value < best.y)) {
+          best = dlib::function_evaluation(input, value);
+        }
+        if(should_stop(value)) throw refine_stop{};
+        return (maximize) ? -value : value;
+      };
+
+      //BOBYQA requires the initial trust region to fit inside the bounds
+      const double radius_begin = std::min(refine_radius, .49);
+      const double radius_end = radius_begin * 1e-3;
+      try {
+        if(n_dims == 1) {
+          double x = start(0);
+          dlib::find_min_single_variable(
+              [&](double value) {
+                dlib::matrix<double,0,1> unit(1);
+                unit(0) = value;
+                return unit_objective(unit);
+              },
+              x, 0.0, 1.0, radius_end, max_evaluations, radius_begin);
+        } else {
+          dlib::find_min_bobyqa(
+              unit_objective,
+              start,
+              static_cast<long>(2*n_dims + 1),
+              vector_to_dlib(std::vector<double>(n_dims, 0.0)),
+              vector_to_dlib(std::vector<double>(n_dims, 1.0)),
+              radius_begin,
+              radius_end,
+              max_evaluations + 1);
+        }
+      } catch(refine_stop const&) {
+        //the budget was used or the stop condition was met
+      } catch(dlib::error const&) {
+        //dlib reports running out of evaluations before converging as an error
+      }
+      return best;
+    }
+
+    unsigned int refine_iterations() const {
+      return static_cast<unsigned int>(std::floor(max_iterations * refine_fraction));
+    }
+
+    /**
+     * starting threads for each search is expensive when fraz is nested in another searcher,
+     * so the pool is created by the first search and kept for later searches by this searcher
+     */
+    void update_pool() {
+      const size_t pool_size = (thread_safe) ? (nthreads): (1);
+      if(!pool || pool->num_threads_in_pool() != pool_size) {
+        pool = std::make_shared<dlib::thread_pool>(pool_size);
+      }
+    }
 
     pressio_search_results::input_type lower_bound{};
     pressio_search_results::input_type upper_bound{};
     std::vector<bool> is_integral_config{};
     compat::optional<pressio_search_results::output_type::value_type> target{};
     pressio_data evaluations_data;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
     double local_tolerance = .01;
     double global_rel_tolerance = .1;
     unsigned int max_iterations = 100;
     unsigned int max_seconds = std::numeric_limits<unsigned int>::max();
+    double time_budget = std::numeric_limits<double>::max();
     unsigned int mode = pressio_search_mode_target;
     unsigned int nthreads = 1;
+    double cache_tolerance = 0;
     uint32_t inter_iteration = 1;
     int thread_safe = 0;
+    uint64_t cache_hits = 0;
+    uint64_t cache_coalesced = 0;
+    uint64_t cache_misses = 0;
+    std::shared_ptr<dlib::thread_pool> pool;
+    int distributed = 0;
+    double refine_fraction = 0;
+    double refine_radius = .1;
+    MPI_Comm comm = MPI_COMM_WORLD;
 };
 
 
@@ -1,6 +1,9 @@
 #include "pressio_search.h"
 #include "pressio_search_results.h"
 #include "pressio_search_defines.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
 #include <libpressio_ext/cpp/pressio.h>
 #include <std_compat/memory.h>
 
@@ -15,9 +18,12 @@ struct guess_first_search: public pressio_search_plugin {
                                           pressio_search_results::input_type const &)> compress_fn,
                                   distributed::queue::StopToken &stop_token) override {
       pressio_search_results results{};
+      pressio_search_budget budget(time_budget);
+      pressio_search_cache cache(compress_fn);
       results.inputs = input;
-      results.output = compress_fn(input);
-      switch(mode) {
+      results.output = cache(input);
+      //an infeasible guess is never accepted
+      switch(constraints.feasible(results.output) ? mode : static_cast<unsigned int>(pressio_search_mode_none)) {
         case pressio_search_mode_target:
           {
             if(results.output.front() < *target * (1+ global_rel_tolerance) && 
@@ -46,7 +52,20 @@ struct guess_first_search: public pressio_search_plugin {
         default:
           break;
       }
-      return search_method->search(input_datas, compress_fn, stop_token);
+      if(budget.expired()) {
+        results.status = -2;
+        results.msg = "time-limit exceeded";
+        return results;
+      }
+      //the nested search starts from the guess and gets whatever time remains after it
+      pressio_search_evaluations_guard restore(search_method, evaluations_data);
+      pressio_options seed_options;
+      seed_options.set("opt:evaluations", seed_evaluations(cache.history(), constraints, input.size(), evaluations_data));
+      if(budget.limited()) {
+        seed_options.set("opt:time_budget", budget.remaining());
+      }
+      search_method->set_options(seed_options);
+      return search_method->search(input_datas, std::ref(cache), stop_token);
     }
 
     //configuration
@@ -63,6 +82,10 @@ struct guess_first_search: public pressio_search_plugin {
       set(opts, "opt:target", target);
       set(opts, "opt:objective_mode", mode);
       set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
       set_meta(opts, "guess_first:search", search_method_str, search_method);
 
       return opts;
@@ -75,6 +98,12 @@ struct guess_first_search: public pressio_search_plugin {
       }
       get(options, "opt:target", &target);
       get(options, "opt:objective_mode", &mode);
+      get(options, "opt:time_budget", &time_budget);
+      get(options, "opt:evaluations", &evaluations_data);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
       get_meta(options, "guess_first:search", search_plugins(), search_method_str, search_method);
       return 0;
     }
@@ -112,6 +141,10 @@ struct guess_first_search: public pressio_search_plugin {
       return compat::make_unique<guess_first_search>(*this);
     }
 
+    pressio_options get_metrics_results() const override {
+      return search_method->get_metrics_results();
+    }
+
     std::vector<std::string> children() const final override {
         return {
             search_method->get_name()
@@ -123,6 +156,9 @@ private:
     compat::optional<pressio_search_results::output_type::value_type> target;
     unsigned int mode = pressio_search_mode_target;
     double global_rel_tolerance = 0.0;
+    double time_budget = std::numeric_limits<double>::max();
+    pressio_data evaluations_data;
+    pressio_search_constraints constraints;
     std::string search_method_str = "guess";
     pressio_search search_method;
 };
@@ -1,5 +1,6 @@
 #include "pressio_search.h"
 #include "pressio_search_results.h"
+#include "pressio_search_transform.h"
 #include <std_compat/numeric.h>
 #include <std_compat/memory.h>
 #include <algorithm>
@@ -10,19 +11,28 @@ struct guess_midpoint_search: public pressio_search_plugin {
                                   std::function<pressio_search_results::output_type(
                                           pressio_search_results::input_type const &)> compress_fn,
                                   distributed::queue::StopToken &) override {
-      pressio_search_results::input_type midpoint(lower_bound.size());
+      pressio_search_results results{};
+      //the midpoint is taken in the search space, e.g. the geometric mean for log10
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      pressio_search_results::input_type search_midpoint(search_lower.size());
       using value_type = pressio_search_results::input_type::value_type;
       std::transform(
-          std::begin(lower_bound),
-          std::end(lower_bound),
-          std::begin(upper_bound),
-          std::begin(midpoint),
+          std::begin(search_lower),
+          std::end(search_lower),
+          std::begin(search_upper),
+          std::begin(search_midpoint),
           [](value_type lower, value_type upper) {
             return compat::midpoint(lower, upper);
           }
           );
+      auto const midpoint = transform.from_search(search_midpoint);
 
-      pressio_search_results results{};
       results.inputs = midpoint;
       results.output = compress_fn(midpoint);
       return results;
@@ -33,6 +43,7 @@ struct guess_midpoint_search: public pressio_search_plugin {
       pressio_options opts;
       set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
       set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      set(opts, "opt:transform", transform.names());
       return opts;
     }
 
@@ -44,6 +55,10 @@ struct guess_midpoint_search: public pressio_search_plugin {
       if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
         upper_bound = data.to_vector<pressio_search_results::input_element_type>();
       }
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
       return 0;
     }
     
@@ -79,6 +94,7 @@ struct guess_midpoint_search: public pressio_search_plugin {
 private:
     pressio_search_results::input_type lower_bound;
     pressio_search_results::input_type upper_bound;
+    pressio_search_transform transform;
 };
 
 
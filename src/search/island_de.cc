@@ -0,0 +1,401 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <random>
+#include <thread>
+#include <time.h>
+#include <mpi.h>
+#include "pressio_search.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_results.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_mailbox.h"
+#include "pressio_search_transform.h"
+#include <std_compat/memory.h>
+#include <libpressio_ext/cpp/distributed_manager.h>
+
+namespace {
+  /** the tags used for messages between islands */
+  enum island_tag {
+    island_tag_migrant = 1,
+    island_tag_stop = 2,
+  };
+}
+
+/**
+ * island model differential evolution (DE/rand/1/bin) across the ranks of the distributed manager.
+ *
+ * Each rank evolves its own population and periodically sends its best individual to the next
+ * rank in a ring with non-blocking messages, so no rank waits on a master or its neighbors.
+ */
+struct island_de_search: public pressio_search_plugin {
+  public:
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &token) override {
+      pressio_search_results results;
+      if(mode == pressio_search_mode_target && not target) {
+        results.status = 1;
+        results.msg = "island_de requires opt:target in target mode";
+        return results;
+      }
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
+      const size_t n_dims = search_lower.size();
+      //the islands exchange messages and reduce their results on the same communicator
+      pressio_search_mailbox mailbox(comm);
+      const int rank = mailbox.rank(), size = mailbox.size();
+      auto last_time = std::chrono::system_clock::now();
+      auto max_time = std::chrono::system_clock::now() + std::chrono::seconds(max_seconds);
+      pressio_search_budget budget(time_budget);
+      pressio_search_feasibility feasibility(constraints);
+
+      const pressio_search_objective goal(mode, target, global_rel_tolerance);
+      const pressio_search_unit_cube cube(search_lower, search_upper, is_integral, transform);
+
+      //each island uses its share of the evaluations and a different random stream
+      const size_t max_evaluations = (max_iterations + size - 1) / size;
+      std::mt19937_64 gen(seed.value_or(time(nullptr)) + static_cast<uint64_t>(rank));
+      std::uniform_real_distribution<double> uniform(0.0, 1.0);
+      const size_t pop_size = std::max<size_t>(4, (population) ? population : 5 * n_dims);
+
+      std::vector<std::vector<double>> pop(pop_size, std::vector<double>(n_dims));
+      for (auto& individual : pop) {
+        for (auto& value : individual) value = uniform(gen);
+      }
+      //seed the population of each island with the best prior evaluations
+      try {
+        auto const prior = evaluations_to_history(transform.evaluations_to_search(evaluations_data, n_dims), n_dims);
+        std::vector<std::pair<double, std::vector<double>>> ranked;
+        for (auto const& eval : prior) {
+          ranked.emplace_back(goal.loss(eval.second), cube.to_unit(eval.first));
+        }
+        const size_t n_seeds = std::min(ranked.size(), pop_size / 2);
+        std::partial_sort(std::begin(ranked), std::begin(ranked) + n_seeds, std::end(ranked));
+        for (size_t i = 0; i < n_seeds; ++i) {
+          pop[i] = ranked[i].second;
+        }
+      } catch(std::runtime_error const& err) {
+        results.status = -1;
+        results.msg = err.what();
+        return results;
+      }
+      std::vector<double> pop_loss(pop_size, std::numeric_limits<double>::infinity());
+
+      compat::optional<pressio_search_results::input_type> best_input;
+      pressio_search_results::output_type best_output;
+      size_t evaluations = 0;
+      bool done = false;
+      bool stop_received = false;
+      auto is_stopped = [&]() {
+        return done || stop_received || (evaluations >= max_evaluations) ||
+          (max_seconds > 0 && (last_time = std::chrono::system_clock::now()) > max_time) ||
+          budget.expired() ||
+          token.stop_requested();
+      };
+
+      const size_t workers = (thread_safe) ? std::max(1u, nthreads) : 1;
+      std::vector<std::vector<double>> trials(pop_size);
+      std::vector<pressio_search_results::input_type> inputs(pop_size);
+      std::vector<pressio_search_results::output_type> outputs(pop_size);
+      std::vector<std::exception_ptr> errors(pop_size);
+      //evaluates inputs[0,count) in parallel if possible and returns their losses
+      auto evaluate_all = [&](size_t count, std::vector<double>& losses) {
+        auto evaluate = [&](size_t i) {
+          try {
+            outputs[i].clear();
+            if(!feasibility.pruned(inputs[i])) {
+              outputs[i] = compress_fn(inputs[i]);
+              feasibility.record(inputs[i], outputs[i]);
+            }
+          } catch(...) {
+            errors[i] = std::current_exception();
+          }
+        };
+        if(workers > 1) {
+          for (size_t first = 0; first < count; first += workers) {
+            std::vector<std::thread> threads;
+            for (size_t i = first; i < std::min(first + workers, count); ++i) {
+              threads.emplace_back(evaluate, i);
+            }
+            for (auto& thread : threads) {
+              thread.join();
+            }
+          }
+        } else {
+          for (size_t i = 0; i < count; ++i) {
+            evaluate(i);
+          }
+        }
+        for (size_t i = 0; i < count; ++i) {
+          if(errors[i]) std::rethrow_exception(errors[i]);
+        }
+        evaluations += count;
+        losses.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+          const bool feasible = !outputs[i].empty() && constraints.feasible(outputs[i]);
+          losses[i] = feasible ? goal.loss(outputs[i]) : std::numeric_limits<double>::infinity();
+          if(feasible && (not best_input || losses[i] < goal.loss(best_output))) {
+            best_input = inputs[i];
+            best_output = outputs[i];
+            done = done || goal.is_achieved(outputs[i].front());
+          }
+        }
+      };
+
+      auto receive = [&](int tag, std::vector<double> const& message) {
+        switch(tag) {
+          case island_tag_stop:
+            stop_received = true;
+            break;
+          case island_tag_migrant:
+            {
+              //the migrant replaces the worst individual if it is better
+              if(message.size() != n_dims + 1) break;
+              auto worst = std::max_element(std::begin(pop_loss), std::end(pop_loss));
+              if(message.back() < *worst) {
+                const size_t idx = std::distance(std::begin(pop_loss), worst);
+                pop[idx].assign(std::begin(message), std::end(message) - 1);
+                pop_loss[idx] = message.back();
+              }
+            }
+            break;
+        }
+      };
+
+      //evaluate the initial population
+      std::vector<double> losses;
+      const size_t n_initial = std::min(pop_size, max_evaluations);
+      for (size_t i = 0; i < n_initial; ++i) {
+        inputs[i] = cube.from_unit(pop[i]);
+      }
+      evaluate_all(n_initial, losses);
+      std::copy(std::begin(losses), std::end(losses), std::begin(pop_loss));
+
+      for (size_t generation = 1; !is_stopped(); ++generation) {
+        //DE/rand/1/bin: each trial mixes its parent with a scaled difference of two others
+        std::uniform_int_distribution<size_t> pick(0, pop_size - 1);
+        std::uniform_int_distribution<size_t> pick_dim(0, n_dims - 1);
+        const size_t count = std::min(pop_size, max_evaluations - evaluations);
+        for (size_t i = 0; i < count; ++i) {
+          size_t a, b, c;
+          do { a = pick(gen); } while(a == i);
+          do { b = pick(gen); } while(b == i || b == a);
+          do { c = pick(gen); } while(c == i || c == a || c == b);
+          const size_t forced = pick_dim(gen);
+          trials[i] = pop[i];
+          for (size_t dim = 0; dim < n_dims; ++dim) {
+            if(dim == forced || uniform(gen) < crossover) {
+              double value = pop[a][dim] + weight * (pop[b][dim] - pop[c][dim]);
+              //reflect values that leave the bounds back inside
+              if(value < 0.0) value = pop[i][dim] * uniform(gen);
+              if(value > 1.0) value = pop[i][dim] + (1.0 - pop[i][dim]) * uniform(gen);
+              trials[i][dim] = value;
+            }
+          }
+          inputs[i] = cube.from_unit(trials[i]);
+        }
+        evaluate_all(count, losses);
+        for (size_t i = 0; i < count; ++i) {
+          if(losses[i] <= pop_loss[i]) {
+            pop[i] = trials[i];
+            pop_loss[i] = losses[i];
+          }
+        }
+
+        if(size > 1) {
+          if(!done && generation % std::max(1u, migration_interval) == 0) {
+            auto best = std::min_element(std::begin(pop_loss), std::end(pop_loss));
+            if(std::isfinite(*best)) {
+              std::vector<double> migrant = pop[std::distance(std::begin(pop_loss), best)];
+              migrant.push_back(*best);
+              mailbox.send(std::move(migrant), (rank + 1) % size, island_tag_migrant);
+            }
+          }
+          mailbox.poll(receive);
+        }
+      }
+      if(size > 1) {
+        if(done) {
+          //tell the other islands to stop evolving
+          for (int other = 0; other < size; ++other) {
+            if(other != rank) mailbox.send({}, other, island_tag_stop);
+          }
+        }
+        mailbox.drain(receive);
+      }
+
+      //find the island with the best point and share it with every island
+      const int best_rank = mailbox.best_rank((best_input) ? goal.loss(best_output) : std::numeric_limits<double>::infinity());
+      results.inputs = (best_input) ? transform.from_search(*best_input) : pressio_search_results::input_type{};
+      results.output = best_output;
+      mailbox.bcast(results.inputs, best_rank);
+      mailbox.bcast(results.output, best_rank);
+      const bool global_stop = mailbox.any(done || stop_received);
+      const bool global_exhausted = mailbox.any(evaluations >= max_evaluations);
+
+      if(results.output.empty()) {
+        results.status = -3;
+        results.msg = "no feasible point found";
+      } else if(goal.is_achieved(results.output.front())) {
+        token.request_stop();
+      } else if(global_exhausted) {
+        results.status = -1;
+        results.msg = "iterations exceeded";
+      } else if(!global_stop && (last_time > max_time || budget.expired())) {
+        results.status = -2;
+        results.msg = "time-limit exceeded";
+      }
+      return results;
+    }
+
+    //configuration
+    pressio_options get_options() const override {
+      pressio_options opts;
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      std::vector<uint8_t> is_integral_u8(is_integral.begin(), is_integral.end());
+      set(opts, "opt:is_integral", pressio_data(std::begin(is_integral_u8), std::end(is_integral_u8)));
+      set(opts, "opt:max_iterations", max_iterations);
+      set(opts, "opt:max_seconds", max_seconds);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:target", target);
+      set(opts, "opt:objective_mode", mode);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "opt:transform", transform.names());
+      opts.copy_from(manager.get_options());
+      set(opts, "island_de:nthreads", nthreads);
+      set(opts, "island_de:population", population);
+      set(opts, "island_de:weight", weight);
+      set(opts, "island_de:crossover", crossover);
+      set(opts, "island_de:migration_interval", migration_interval);
+      set(opts, "island_de:seed", seed);
+      return opts;
+    }
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:is_integral", &data) == pressio_options_key_set) {
+        auto is_integral_u8 = data.to_vector<uint8_t>();
+        is_integral = std::vector<bool>(is_integral_u8.begin(), is_integral_u8.end());
+      }
+      get(options, "opt:max_iterations", &max_iterations);
+      get(options, "opt:max_seconds", &max_seconds);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:target", &target);
+      get(options, "opt:objective_mode", &mode);
+      get(options, "opt:evaluations", &evaluations_data);
+      get(options, "opt:time_budget", &time_budget);
+      get(options, "opt:thread_safe", &thread_safe);
+      manager.set_options(options);
+      //the same communicator the manager uses, needed for non-blocking migration
+      void* comm_ptr = nullptr;
+      if(get(options, "distributed:mpi_comm", &comm_ptr) == pressio_options_key_set && comm_ptr != nullptr) {
+        comm = (MPI_Comm)comm_ptr;
+      }
+      if(get(options, "distributed:comm", &comm_ptr) == pressio_options_key_set && comm_ptr != nullptr) {
+        comm = (MPI_Comm)comm_ptr;
+      }
+      get(options, "island_de:nthreads", &nthreads);
+      get(options, "island_de:population", &population);
+      get(options, "island_de:weight", &weight);
+      double tmp_crossover;
+      if(get(options, "island_de:crossover", &tmp_crossover) == pressio_options_key_set) {
+        if(!(tmp_crossover >= 0 && tmp_crossover <= 1)) return set_error(1, "island_de:crossover must be in [0,1]");
+        crossover = tmp_crossover;
+      }
+      get(options, "island_de:migration_interval", &migration_interval);
+      get(options, "island_de:seed", &seed);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      return 0;
+    }
+
+    void set_name_impl(std::string const& new_name) override {
+      manager.set_name(new_name);
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "island_de";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<island_de_search>(*this);
+    }
+
+private:
+    pressio_search_results::input_type lower_bound{};
+    pressio_search_results::input_type upper_bound{};
+    std::vector<bool> is_integral{};
+    compat::optional<pressio_search_results::output_type::value_type> target{};
+    pressio_data evaluations_data;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    double global_rel_tolerance = .1;
+    unsigned int max_iterations = 100;
+    unsigned int max_seconds = 0;
+    double time_budget = std::numeric_limits<double>::max();
+    unsigned int mode = pressio_search_mode_target;
+    unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int population = 0;
+    double weight = .8;
+    double crossover = .9;
+    unsigned int migration_interval = 5;
+    compat::optional<unsigned int> seed;
+    int thread_safe = 0;
+    MPI_Comm comm = MPI_COMM_WORLD;
+    pressio_distributed_manager manager = pressio_distributed_manager(
+        /*max_masters*/1,
+        /*max_ranks_per_worker*/1
+        );
+};
+
+
+static pressio_register island_de_register(search_plugins(), "island_de", [](){ return compat::make_unique<island_de_search>();});
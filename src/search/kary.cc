@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <thread>
+#include "dlib/threads.h"
+#include "pressio_search.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_transform.h"
+#include <std_compat/std_compat.h>
+#include <std_compat/memory.h>
+
+/**
+ * a parallel version of binary search for a target with a single input.
+ *
+ * Each round evaluates k evenly spaced points inside the bracket concurrently and
+ * shrinks the bracket to the pair of adjacent points that surround the target,
+ * a factor of k+1 per round.  When the compressor is not thread safe, k is 1 and
+ * this is a binary search.
+ */
+struct kary_search: public pressio_search_plugin {
+  public:
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &token) override {
+      pressio_search_results results;
+      if(not target) {
+        results.status = 1;
+        results.msg = "kary requires opt:target";
+        return results;
+      }
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
+      update_pool();
+      const size_t k = pool->num_threads_in_pool();
+      size_t iter = 0;
+      auto last_time = std::chrono::system_clock::now();
+      auto max_time = std::chrono::system_clock::now() + std::chrono::seconds(max_seconds);
+      pressio_search_budget budget(time_budget);
+      auto is_achieved = [&](pressio_search_results::output_type const& result_v) {
+        return std::abs(result_v.front() - *target) <= std::abs(*target * global_rel_tolerance) &&
+          constraints.feasible(result_v);
+      };
+      auto is_stopped = [&]() {
+        return (iter >= max_iterations) || //exceeded maximum iterations
+          (max_seconds > 0 && (last_time = std::chrono::system_clock::now()) > max_time) || //check for time exceeded
+          budget.expired() || //check for the time budget of the entire search
+          token.stop_requested();
+      };
+
+      double lower = search_lower.front();
+      double upper = search_upper.front();
+      //the oriented objective at the ends of the bracket, when known
+      compat::optional<double> lower_value, upper_value;
+      //+1 if the objective increases with the input, -1 if it decreases
+      compat::optional<double> sign;
+      const double infeasible_direction = (constraints.monotone().empty()) ? 0.0 : constraints.monotone().front();
+
+      compat::optional<double> best_input;
+      pressio_search_results::output_type best_result_v;
+      bool best_feasible = false;
+      bool done = false;
+      bool is_nonmonotonic = false;
+
+      std::vector<double> inputs;
+      std::vector<pressio_search_results::output_type> outputs;
+      std::vector<std::exception_ptr> errors;
+      while(!done && lower < upper && !is_stopped()) {
+        //the last round only uses the evaluations that remain
+        const size_t n = std::min<size_t>(k, max_iterations - iter);
+        inputs.resize(n);
+        outputs.assign(n, {});
+        errors.assign(n, nullptr);
+        for (size_t i = 0; i < n; ++i) {
+          inputs[i] = lower + static_cast<double>(i + 1) * (upper - lower) / static_cast<double>(n + 1);
+        }
+        for (size_t i = 0; i < n; ++i) {
+          pool->add_task_by_value([&, i]() {
+            try {
+              outputs[i] = compress_fn({inputs[i]});
+            } catch(...) {
+              errors[i] = std::current_exception();
+            }
+          });
+        }
+        pool->wait_for_all_tasks();
+        for (auto const& error : errors) {
+          if(error) std::rethrow_exception(error);
+        }
+        iter += n;
+
+        //record the best point from this round
+        for (size_t i = 0; i < n; ++i) {
+          const bool feasible = constraints.feasible(outputs[i]);
+          if(not best_input || (feasible && !best_feasible) ||
+             (feasible == best_feasible && std::abs(outputs[i].front() - *target) < std::abs(best_result_v.front() - *target))) {
+            best_input = inputs[i];
+            best_result_v = outputs[i];
+            best_feasible = feasible;
+          }
+        }
+        if(is_achieved(best_result_v)) {
+          done = true;
+          break;
+        }
+
+        //only the points on the feasible side of infeasible points can bracket the target
+        size_t first = 0, last = n;
+        if(infeasible_direction > 0) {
+          for (size_t i = 0; i < n; ++i) {
+            if(!constraints.feasible(outputs[i])) {
+              last = i;
+              upper = inputs[i];
+              upper_value.reset();
+              break;
+            }
+          }
+        } else if(infeasible_direction < 0) {
+          for (size_t i = n; i > 0; --i) {
+            if(!constraints.feasible(outputs[i-1])) {
+              first = i;
+              lower = inputs[i-1];
+              lower_value.reset();
+              break;
+            }
+          }
+        }
+        if(first >= last) {
+          continue;
+        }
+
+        if(not sign) {
+          //assume an increasing objective like binary unless this round shows otherwise
+          sign = (outputs[last-1].front() < outputs[first].front()) ? -1.0 : 1.0;
+        }
+        std::vector<double> values(last - first);
+        for (size_t i = first; i < last; ++i) {
+          values[i - first] = *sign * (outputs[i].front() - *target);
+        }
+        //check for non-monotonic results, violation of assumptions
+        is_nonmonotonic = !std::is_sorted(std::begin(values), std::end(values)) ||
+          (lower_value && *lower_value > values.front()) ||
+          (upper_value && *upper_value < values.back());
+        if(is_nonmonotonic) {
+          break;
+        }
+
+        //shrink the bracket to the pair of points that surround the target
+        auto const above = std::lower_bound(std::begin(values), std::end(values), 0.0);
+        const size_t idx = first + std::distance(std::begin(values), above);
+        if(idx > first) {
+          lower = inputs[idx - 1];
+          lower_value = values[idx - 1 - first];
+        }
+        if(idx < last) {
+          upper = inputs[idx];
+          upper_value = values[idx - first];
+        }
+      }
+
+      if(done) {
+        token.request_stop();
+      }
+      if(is_nonmonotonic) {
+        results.status = 1;
+        results.msg = "kary search objective function was non-monotonic, violation of assumptions";
+      }
+      if(iter >= max_iterations) {
+        results.status = -1;
+        results.msg = "iterations exceeded";
+      }
+      if(last_time > max_time || budget.expired()) {
+        results.status = -2;
+        results.msg = "time-limit exceeded";
+      }
+      if(best_input) {
+        results.inputs = transform.from_search({*best_input});
+        results.output = best_result_v;
+        if(!best_feasible) {
+          results.status = -3;
+          results.msg = "no feasible point found";
+        }
+      }
+      if(done) {
+        results.status = 0;
+        results.msg.clear();
+      }
+      return results;
+    }
+
+    //configuration
+    pressio_options get_options() const override {
+      pressio_options opts;
+
+      //need to reconfigure because input size has changed
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      set(opts, "opt:max_iterations", max_iterations);
+      set(opts, "opt:max_seconds", max_seconds);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:target", target);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:transform", transform.names());
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "kary:nthreads", nthreads);
+      return opts;
+    }
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+        if(lower_bound.size() != 1) return set_error(1, "kary only supports a single input");
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+        if(upper_bound.size() != 1) return set_error(1, "kary only supports a single input");
+      }
+      get(options, "opt:max_iterations", &max_iterations);
+      get(options, "opt:max_seconds", &max_seconds);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:target", &target);
+      get(options, "opt:time_budget", &time_budget);
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      get(options, "opt:thread_safe", &thread_safe);
+      get(options, "kary:nthreads", &nthreads);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      return 0;
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "kary";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      auto cloned = compat::make_unique<kary_search>(*this);
+      //clones may search concurrently, so each starts its own pool when it first searches
+      cloned->pool.reset();
+      return cloned;
+    }
+
+private:
+    /**
+     * the pool is created by the first search and kept for later searches by this searcher,
+     * with a single thread when the compressor is not thread safe since each round would
+     * otherwise evaluate its points one after another
+     */
+    void update_pool() {
+      const size_t pool_size = (thread_safe) ? std::max(1u, nthreads) : 1;
+      if(!pool || pool->num_threads_in_pool() != pool_size) {
+        pool = std::make_shared<dlib::thread_pool>(pool_size);
+      }
+    }
+
+    pressio_search_results::input_type lower_bound{0.0};
+    pressio_search_results::input_type upper_bound{1.0};
+    compat::optional<pressio_search_results::output_type::value_type> target;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    double global_rel_tolerance = .1;
+    unsigned int max_iterations = 100;
+    unsigned int max_seconds = 0;
+    double time_budget = std::numeric_limits<double>::max();
+    unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+    int thread_safe = 0;
+    std::shared_ptr<dlib::thread_pool> pool;
+};
+
+
+static pressio_register kary_search_register(search_plugins(), "kary", [](){ return compat::make_unique<kary_search>();});
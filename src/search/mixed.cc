@@ -0,0 +1,422 @@
+#include "pressio_search.h"
+#include "pressio_search_results.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_transform.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <std_compat/memory.h>
+#include <std_compat/optional.h>
+
+/**
+ * searches spaces where some inputs are categorical, such as the index of a compressor in
+ * `opt:compressors` or the value of a mode enum.
+ *
+ * Each combination of categories is an arm with its own nested search over the remaining inputs.
+ * The arms share the evaluation budget using successive halving: each round every remaining arm
+ * continues its search with an equal share of the round's evaluations, then the worse half of
+ * the arms are dropped.
+ *
+ * Inputs may only apply to some arms, such as a setting of one of the compressors, so each arm
+ * only searches the continuous inputs that mixed:conditional marks active for it.
+ */
+struct mixed_search: public pressio_search_plugin {
+  public:
+    mixed_search() {
+      search_method = search_plugins().build(search_method_str);
+    }
+
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &token) override {
+      pressio_search_results results;
+      if(mode == pressio_search_mode_target && not target) {
+        results.status = 1;
+        results.msg = "mixed requires opt:target in target mode";
+        return results;
+      }
+      if(lower_bound.size() != upper_bound.size()) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must have the same size";
+        return results;
+      }
+      const size_t n_dims = lower_bound.size();
+      std::vector<size_t> categorical_dims, continuous_dims;
+      for (size_t dim = 0; dim < n_dims; ++dim) {
+        if(dim < categorical.size() && categorical[dim]) categorical_dims.push_back(dim);
+        else continuous_dims.push_back(dim);
+      }
+
+      //each arm is one combination of the integer values of the categorical inputs
+      std::vector<std::vector<double>> arms(1);
+      for (auto dim : categorical_dims) {
+        const double first = std::ceil(lower_bound[dim]), last = std::floor(upper_bound[dim]);
+        if(first > last) {
+          results.status = 1;
+          results.msg = "categorical input " + std::to_string(dim) + " has no integer values in its bounds";
+          return results;
+        }
+        std::vector<std::vector<double>> expanded;
+        for (auto const& arm : arms) {
+          for (double category = first; category <= last; ++category) {
+            expanded.push_back(arm);
+            expanded.back().push_back(category);
+          }
+        }
+        arms = std::move(expanded);
+      }
+      const size_t n_arms = arms.size();
+
+      //the continuous inputs each arm searches, the others are held at their lower bound
+      std::vector<std::vector<size_t>> arm_dims(n_arms, continuous_dims);
+      auto const conditional_u8 = conditional.to_vector<uint8_t>();
+      if(!conditional_u8.empty()) {
+        if(conditional_u8.size() != n_dims * n_arms) {
+          results.status = 1;
+          results.msg = "mixed:conditional must have " + std::to_string(n_dims) + "x" + std::to_string(n_arms) +
+            " entries, one for each input of each arm";
+          return results;
+        }
+        for (size_t i = 0; i < n_arms; ++i) {
+          arm_dims[i].clear();
+          for (auto dim : continuous_dims) {
+            if(conditional_u8[i * n_dims + dim]) arm_dims[i].push_back(dim);
+          }
+        }
+      }
+
+      auto to_full = [&](size_t i, pressio_search_results::input_type const& continuous) {
+        pressio_search_results::input_type input(lower_bound);
+        for (size_t j = 0; j < categorical_dims.size(); ++j) input[categorical_dims[j]] = arms[i][j];
+        for (size_t j = 0; j < arm_dims[i].size(); ++j) input[arm_dims[i][j]] = continuous[j];
+        return input;
+      };
+
+      //the prior evaluations belong to the arm whose categories they match
+      std::vector<pressio_search_history> arm_priors(n_arms);
+      try {
+        for (auto const& eval : evaluations_to_history(evaluations_data, n_dims)) {
+          std::vector<double> arm;
+          for (auto dim : categorical_dims) arm.push_back(std::round(eval.first[dim]));
+          auto const it = std::find(std::begin(arms), std::end(arms), arm);
+          if(it != std::end(arms)) {
+            const size_t i = std::distance(std::begin(arms), it);
+            arm_priors[i].emplace(input_slice{arm_dims[i]}(eval.first), eval.second);
+          }
+        }
+      } catch(std::runtime_error const& err) {
+        results.status = -1;
+        results.msg = err.what();
+        return results;
+      }
+
+      pressio_search_budget budget(time_budget);
+      std::vector<std::unique_ptr<pressio_search_cache>> arm_caches;
+      std::vector<pressio_search> arm_searches;
+      for (size_t i = 0; i < n_arms; ++i) {
+        arm_caches.emplace_back(compat::make_unique<pressio_search_cache>(
+            [i, &to_full, &compress_fn](pressio_search_results::input_type const& continuous) {
+              return compress_fn(to_full(i, continuous));
+            }));
+        arm_searches.emplace_back(search_method);
+      }
+      auto evaluations_used = [&]() {
+        size_t used = 0;
+        for (auto const& cache : arm_caches) used += cache->misses();
+        return used;
+      };
+      //the best feasible loss of an arm, or infinity if it has none
+      auto arm_loss = [&](size_t i) {
+        double best = std::numeric_limits<double>::infinity();
+        auto consider = [&](pressio_search_history const& history, bool check_constraints) {
+          for (auto const& eval : history) {
+            if(eval.second.empty() || (check_constraints && !constraints.feasible(eval.second))) continue;
+            best = std::min(best, goal().loss(eval.second.front()));
+          }
+        };
+        consider(arm_priors[i], false);
+        consider(arm_caches[i]->history(), true);
+        return best;
+      };
+      auto arm_achieved = [&](size_t i) {
+        auto const history = arm_caches[i]->history();
+        return std::any_of(std::begin(history), std::end(history), [this](pressio_search_history::value_type const& eval) {
+            return !eval.second.empty() && constraints.feasible(eval.second) && goal().is_achieved(eval.second.front());
+        });
+      };
+
+      std::vector<size_t> alive(n_arms);
+      std::iota(std::begin(alive), std::end(alive), 0);
+      arm_rounds.assign(n_arms, 0);
+      size_t rounds_left = 1;
+      while((size_t{1} << (rounds_left - 1)) < n_arms) ++rounds_left;
+      bool done = false;
+      int child_status = 0;
+      std::string child_msg;
+      while(!done && !alive.empty() && rounds_left > 0) {
+        const size_t used = evaluations_used();
+        if(used >= max_iterations || budget.expired() || token.stop_requested()) break;
+        const size_t round_evaluations = (max_iterations - used) / rounds_left;
+        const size_t arm_evaluations = std::max<size_t>(1, round_evaluations / alive.size());
+
+        for (size_t a = 0; a < alive.size() && !done; ++a) {
+          const size_t i = alive[a];
+          if(evaluations_used() >= max_iterations || budget.expired() || token.stop_requested()) {
+            done = true;
+            break;
+          }
+          ++arm_rounds[i];
+          auto const& dims = arm_dims[i];
+          input_slice slice{dims};
+          if(dims.empty()) {
+            //nothing to search, evaluate the arm once
+            if(arm_caches[i]->misses() == 0) (*arm_caches[i])({});
+          } else {
+            pressio_options arm_options;
+            arm_options.set("opt:lower_bound", to_data(slice(lower_bound)));
+            arm_options.set("opt:upper_bound", to_data(slice(upper_bound)));
+            if(is_integral.size() == n_dims) {
+              std::vector<uint8_t> arm_integral;
+              for (auto dim : dims) arm_integral.push_back(is_integral[dim]);
+              arm_options.set("opt:is_integral", pressio_data(std::begin(arm_integral), std::end(arm_integral)));
+            }
+            auto const transform_names = transform.names();
+            if(transform_names.size() == n_dims) {
+              std::vector<std::string> arm_transform;
+              for (auto dim : dims) arm_transform.push_back(transform_names[dim]);
+              arm_options.set("opt:transform", arm_transform);
+            }
+            auto const& monotone = constraints.monotone();
+            if(monotone.size() == n_dims) {
+              arm_options.set("opt:constraints_monotone", to_data(slice(monotone)));
+            }
+            //continue the search of the arm from everything it has evaluated
+            arm_options.set("opt:evaluations", history_to_evaluations(arm_caches[i]->history(), dims.size(),
+                  history_to_evaluations(arm_priors[i], dims.size())));
+            arm_options.set("opt:max_iterations", static_cast<unsigned int>(arm_evaluations));
+            arm_options.set("opt:time_budget", budget.share(rounds_left * alive.size() - a));
+            if(arm_searches[i]->set_options(arm_options)) {
+              results.status = 1;
+              results.msg = arm_searches[i]->error_msg();
+              return results;
+            }
+            auto const arm_results = arm_searches[i]->search(input_datas, std::ref(*arm_caches[i]), token);
+            if(arm_results.status > 0) {
+              child_status = arm_results.status;
+              child_msg = arm_results.msg;
+              done = true;
+            }
+          }
+          done = done || arm_achieved(i);
+        }
+        --rounds_left;
+
+        //keep the better half of the arms
+        std::vector<std::pair<double, size_t>> ranked;
+        for (auto i : alive) ranked.emplace_back(arm_loss(i), i);
+        std::stable_sort(std::begin(ranked), std::end(ranked));
+        alive.clear();
+        const size_t keep = (rounds_left > 0) ? (ranked.size() + 1) / 2 : ranked.size();
+        for (size_t r = 0; r < keep; ++r) alive.push_back(ranked[r].second);
+      }
+      if(child_status) {
+        results.status = child_status;
+        results.msg = child_msg;
+        return results;
+      }
+
+      //choose the best evaluation of any arm
+      double best_loss = std::numeric_limits<double>::infinity();
+      compat::optional<size_t> best_arm;
+      for (size_t i = 0; i < n_arms; ++i) {
+        for (auto const& eval : arm_caches[i]->history()) {
+          if(eval.second.empty() || !constraints.feasible(eval.second)) continue;
+          const double eval_loss = goal().loss(eval.second.front());
+          if(results.output.empty() || eval_loss < best_loss) {
+            best_loss = eval_loss;
+            results.inputs = to_full(i, eval.first);
+            results.output = eval.second;
+            best_arm = i;
+          }
+        }
+      }
+      if(best_arm && !arm_dims[*best_arm].empty()) {
+        best_arm_search = arm_searches[*best_arm];
+      } else {
+        best_arm_search.reset();
+      }
+      if(results.output.empty()) {
+        results.status = (constraints.empty()) ? -1 : -3;
+        results.msg = (constraints.empty()) ? "iterations exceeded" : "no feasible point found";
+      } else if(goal().is_achieved(results.output.front())) {
+        token.request_stop();
+      } else if(budget.expired()) {
+        results.status = -2;
+        results.msg = "time-limit exceeded";
+      } else if(evaluations_used() >= max_iterations) {
+        results.status = -1;
+        results.msg = "iterations exceeded";
+      }
+      return results;
+    }
+
+    //configuration
+    pressio_options get_configuration_impl() const override {
+      pressio_options opts;
+      set_meta_configuration(opts, "mixed:search", search_plugins(), search_method);
+      return opts;
+    }
+
+    pressio_options get_options() const override {
+      pressio_options opts;
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      std::vector<uint8_t> is_integral_u8(is_integral.begin(), is_integral.end());
+      set(opts, "opt:is_integral", pressio_data(std::begin(is_integral_u8), std::end(is_integral_u8)));
+      set(opts, "opt:max_iterations", max_iterations);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:target", target);
+      set(opts, "opt:objective_mode", mode);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "opt:transform", transform.names());
+      std::vector<uint8_t> categorical_u8(categorical.begin(), categorical.end());
+      set(opts, "mixed:categorical", pressio_data(std::begin(categorical_u8), std::end(categorical_u8)));
+      set(opts, "mixed:conditional", conditional);
+      set_meta(opts, "mixed:search", search_method_str, search_method);
+      return opts;
+    }
+
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:is_integral", &data) == pressio_options_key_set) {
+        auto is_integral_u8 = data.to_vector<uint8_t>();
+        is_integral = std::vector<bool>(is_integral_u8.begin(), is_integral_u8.end());
+      }
+      if(get(options, "mixed:categorical", &data) == pressio_options_key_set) {
+        auto categorical_u8 = data.to_vector<uint8_t>();
+        categorical = std::vector<bool>(categorical_u8.begin(), categorical_u8.end());
+      }
+      get(options, "mixed:conditional", &conditional);
+      get(options, "opt:max_iterations", &max_iterations);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:target", &target);
+      get(options, "opt:objective_mode", &mode);
+      get(options, "opt:evaluations", &evaluations_data);
+      get(options, "opt:time_budget", &time_budget);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      get_meta(options, "mixed:search", search_plugins(), search_method_str, search_method);
+      return 0;
+    }
+
+    pressio_options get_metrics_results() const override {
+      pressio_options metrics = (best_arm_search) ? (*best_arm_search)->get_metrics_results() : search_method->get_metrics_results();
+      set(metrics, "mixed:rounds", pressio_data(std::begin(arm_rounds), std::end(arm_rounds)));
+      return metrics;
+    }
+
+    void set_name_impl(std::string const& new_name) override {
+      search_method->set_name(new_name + "/" + search_method->prefix());
+    }
+
+    std::vector<std::string> children() const final override {
+        return {
+            search_method->get_name()
+        };
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "mixed";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<mixed_search>(*this);
+    }
+
+private:
+    /** selects the continuous inputs of a point */
+    struct input_slice {
+      std::vector<size_t> const& dims;
+      template <class T>
+      std::vector<T> operator()(std::vector<T> const& values) const {
+        std::vector<T> sliced;
+        for (auto dim : dims) sliced.push_back(values[dim]);
+        return sliced;
+      }
+    };
+
+    template <class T>
+    static pressio_data to_data(std::vector<T> const& values) {
+      return pressio_data(std::begin(values), std::end(values));
+    }
+
+    /** \returns the objective of the search */
+    pressio_search_objective goal() const {
+      return pressio_search_objective(mode, target, global_rel_tolerance);
+    }
+
+    pressio_search_results::input_type lower_bound{};
+    pressio_search_results::input_type upper_bound{};
+    std::vector<bool> is_integral{};
+    std::vector<bool> categorical{};
+    pressio_data conditional;
+    compat::optional<pressio_search_results::output_type::value_type> target{};
+    pressio_data evaluations_data;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    double global_rel_tolerance = .1;
+    unsigned int max_iterations = 100;
+    double time_budget = std::numeric_limits<double>::max();
+    unsigned int mode = pressio_search_mode_target;
+    std::string search_method_str = "fraz";
+    pressio_search search_method;
+    std::vector<uint32_t> arm_rounds;
+    compat::optional<pressio_search> best_arm_search;
+};
+
+
+static pressio_register mixed_register(search_plugins(), "mixed", [](){ return compat::make_unique<mixed_search>();});
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <time.h>
+#include "pressio_search.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_results.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_sequence.h"
+#include "pressio_search_transform.h"
+#include <std_compat/memory.h>
+
+/**
+ * runs a compass search from each point of a space filling design concurrently.
+ *
+ * Each start polls one step in each direction along each input, moves to the first point that
+ * improves, and halves its step when none do.  A start stops once it comes within
+ * `multistart:merge_distance` of a better start, since both have found the same basin.
+ */
+struct multistart_search: public pressio_search_plugin {
+  public:
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &token) override {
+      pressio_search_results results;
+      if(mode == pressio_search_mode_target && not target) {
+        results.status = 1;
+        results.msg = "multistart requires opt:target in target mode";
+        return results;
+      }
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
+      const size_t n_dims = search_lower.size();
+      pressio_search_budget budget(time_budget);
+      const pressio_search_objective goal(mode, target, global_rel_tolerance);
+      const pressio_search_unit_cube cube(search_lower, search_upper, is_integral, transform);
+
+      //the starting points, beginning with the best prior evaluation if there is one
+      std::vector<std::vector<double>> start_points;
+      pressio_search_history priors;
+      try {
+        priors = evaluations_to_history(transform.evaluations_to_search(evaluations_data, n_dims), n_dims);
+      } catch(std::runtime_error const& err) {
+        results.status = -1;
+        results.msg = err.what();
+        return results;
+      }
+      if(!priors.empty()) {
+        auto best_prior = std::min_element(std::begin(priors), std::end(priors), [&](pressio_search_history::value_type const& lhs, pressio_search_history::value_type const& rhs) {
+            return goal.loss(lhs.second) < goal.loss(rhs.second);
+        });
+        start_points.push_back(cube.to_unit(best_prior->first));
+      }
+      //prior evaluations only contain the objective, so they are only reused if there are no constraints
+      if(!constraints.empty()) {
+        priors.clear();
+      }
+      const pressio_search_sequence design(pressio_search_sequence::kind::lhs, n_dims, std::max(1u, starts),
+          seed.value_or(time(nullptr)), true);
+      for (uint64_t i = 0; start_points.size() < std::max(1u, starts); ++i) {
+        start_points.push_back(design.point(i));
+      }
+
+      pressio_search_incumbent incumbent(compress_fn, goal, constraints, cube, std::move(priors),
+          max_iterations, max_seconds, budget, token);
+      std::mutex mutex;
+      //the current point and loss of each start, used to merge starts in the same basin
+      std::vector<std::vector<double>> positions(start_points.size());
+      std::vector<double> position_losses(start_points.size(), std::numeric_limits<double>::infinity());
+      size_t next_start = 0;
+
+      //records the position of a start, \returns true if a better start is already in the same basin
+      auto merged = [&](size_t id, std::vector<double> const& position, double value) {
+        std::lock_guard<std::mutex> guard(mutex);
+        positions[id] = position;
+        position_losses[id] = value;
+        for (size_t other = 0; other < positions.size(); ++other) {
+          if(other == id || positions[other].empty() || !(position_losses[other] <= value)) continue;
+          if(position_losses[other] == value && other > id) continue;
+          double distance = 0;
+          for (size_t dim = 0; dim < n_dims; ++dim) {
+            distance += (positions[other][dim] - position[dim]) * (positions[other][dim] - position[dim]);
+          }
+          if(std::sqrt(distance) < merge_distance) {
+            return true;
+          }
+        }
+        return false;
+      };
+
+      auto local_search = [&](size_t id) {
+        std::vector<double> current = cube.to_unit(cube.from_unit(start_points[id]));
+        double current_value;
+        if(!incumbent.evaluate(current, current_value) || merged(id, current, current_value)) return;
+        std::vector<double> step(n_dims, initial_step);
+        while(true) {
+          bool improved = false;
+          bool polled = false;
+          for (size_t dim = 0; dim < n_dims && !improved; ++dim) {
+            if(step[dim] < cube.min_step(dim, tolerance)) continue;
+            polled = true;
+            for (double direction : {1.0, -1.0}) {
+              auto candidate = current;
+              candidate[dim] = std::min(std::max(candidate[dim] + direction * step[dim], 0.0), 1.0);
+              candidate = cube.to_unit(cube.from_unit(candidate));
+              if(candidate == current) continue;
+              double value;
+              if(!incumbent.evaluate(candidate, value)) return;
+              if(value < current_value) {
+                current = std::move(candidate);
+                current_value = value;
+                improved = true;
+                break;
+              }
+            }
+          }
+          if(!polled) break;
+          if(improved) {
+            if(merged(id, current, current_value)) return;
+          } else {
+            for (size_t dim = 0; dim < n_dims; ++dim) {
+              //let integral inputs make a final poll at exactly one unit
+              const double min_step = cube.min_step(dim, tolerance);
+              step[dim] = (step[dim] > min_step) ? std::max(step[dim] / 2.0, min_step) : 0.0;
+            }
+          }
+        }
+      };
+
+      auto worker = [&]() {
+        while(!incumbent.should_stop()) {
+          size_t id;
+          {
+            std::lock_guard<std::mutex> guard(mutex);
+            if(next_start >= start_points.size()) return;
+            id = next_start++;
+          }
+          local_search(id);
+        }
+      };
+
+      const size_t n_workers = (thread_safe) ? std::min<size_t>(std::max(1u, nthreads), start_points.size()) : 1;
+      pressio_search_run_workers(n_workers, worker, [&incumbent]() { incumbent.stop(); });
+      return incumbent.results(transform);
+    }
+
+    //configuration
+    pressio_options get_options() const override {
+      pressio_options opts;
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      std::vector<uint8_t> is_integral_u8(is_integral.begin(), is_integral.end());
+      set(opts, "opt:is_integral", pressio_data(std::begin(is_integral_u8), std::end(is_integral_u8)));
+      set(opts, "opt:max_iterations", max_iterations);
+      set(opts, "opt:max_seconds", max_seconds);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:target", target);
+      set(opts, "opt:objective_mode", mode);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "opt:transform", transform.names());
+      set(opts, "multistart:nthreads", nthreads);
+      set(opts, "multistart:starts", starts);
+      set(opts, "multistart:initial_step", initial_step);
+      set(opts, "multistart:tolerance", tolerance);
+      set(opts, "multistart:merge_distance", merge_distance);
+      set(opts, "multistart:seed", seed);
+      return opts;
+    }
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:is_integral", &data) == pressio_options_key_set) {
+        auto is_integral_u8 = data.to_vector<uint8_t>();
+        is_integral = std::vector<bool>(is_integral_u8.begin(), is_integral_u8.end());
+      }
+      get(options, "opt:max_iterations", &max_iterations);
+      get(options, "opt:max_seconds", &max_seconds);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:target", &target);
+      get(options, "opt:objective_mode", &mode);
+      get(options, "opt:evaluations", &evaluations_data);
+      get(options, "opt:time_budget", &time_budget);
+      get(options, "opt:thread_safe", &thread_safe);
+      get(options, "multistart:nthreads", &nthreads);
+      get(options, "multistart:starts", &starts);
+      get(options, "multistart:initial_step", &initial_step);
+      get(options, "multistart:tolerance", &tolerance);
+      get(options, "multistart:merge_distance", &merge_distance);
+      get(options, "multistart:seed", &seed);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      return 0;
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "multistart";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<multistart_search>(*this);
+    }
+
+private:
+    pressio_search_results::input_type lower_bound{};
+    pressio_search_results::input_type upper_bound{};
+    std::vector<bool> is_integral{};
+    compat::optional<pressio_search_results::output_type::value_type> target{};
+    pressio_data evaluations_data;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    double global_rel_tolerance = .1;
+    unsigned int max_iterations = 100;
+    unsigned int max_seconds = 0;
+    double time_budget = std::numeric_limits<double>::max();
+    unsigned int mode = pressio_search_mode_target;
+    unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int starts = 8;
+    double initial_step = .25;
+    double tolerance = 1e-4;
+    double merge_distance = .05;
+    compat::optional<unsigned int> seed;
+    int thread_safe = 0;
+};
+
+
+static pressio_register multistart_register(search_plugins(), "multistart", [](){ return compat::make_unique<multistart_search>();});
@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <time.h>
+#include "pressio_search.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_results.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_sequence.h"
+#include "pressio_search_transform.h"
+#include <std_compat/memory.h>
+
+namespace {
+  /** an evaluated member of the population */
+  struct individual {
+    std::vector<double> unit;
+    pressio_search_results::input_type input;
+    pressio_search_results::output_type output;
+    /** the objectives oriented so that smaller is better */
+    std::vector<double> objectives;
+    double violation = std::numeric_limits<double>::infinity();
+    size_t rank = 0;
+    double crowding = 0;
+  };
+
+  /** constrained domination: feasible points dominate infeasible ones, which are ordered by their violation */
+  bool dominates(individual const& lhs, individual const& rhs) {
+    if(lhs.violation != rhs.violation) return lhs.violation < rhs.violation;
+    if(lhs.violation > 0) return false;
+    bool strictly = false;
+    for (size_t i = 0; i < lhs.objectives.size() && i < rhs.objectives.size(); ++i) {
+      if(lhs.objectives[i] > rhs.objectives[i]) return false;
+      if(lhs.objectives[i] < rhs.objectives[i]) strictly = true;
+    }
+    return strictly;
+  }
+
+  /** assigns the non-domination rank and crowding distance of each individual, \returns the fronts in order */
+  std::vector<std::vector<size_t>> sort_fronts(std::vector<individual>& pop) {
+    const size_t n = pop.size();
+    std::vector<std::vector<size_t>> dominated(n);
+    std::vector<size_t> count(n, 0);
+    std::vector<std::vector<size_t>> fronts(1);
+    for (size_t p = 0; p < n; ++p) {
+      for (size_t q = 0; q < n; ++q) {
+        if(p == q) continue;
+        if(dominates(pop[p], pop[q])) dominated[p].push_back(q);
+        else if(dominates(pop[q], pop[p])) ++count[p];
+      }
+      if(count[p] == 0) {
+        pop[p].rank = 0;
+        fronts[0].push_back(p);
+      }
+    }
+    for (size_t f = 0; !fronts[f].empty(); ++f) {
+      std::vector<size_t> next;
+      for (auto p : fronts[f]) {
+        for (auto q : dominated[p]) {
+          if(--count[q] == 0) {
+            pop[q].rank = f + 1;
+            next.push_back(q);
+          }
+        }
+      }
+      fronts.push_back(std::move(next));
+    }
+    fronts.pop_back();
+
+    for (auto const& front : fronts) {
+      for (auto p : front) pop[p].crowding = 0;
+      //points that could not be evaluated have no objectives
+      size_t n_objectives = std::numeric_limits<size_t>::max();
+      for (auto p : front) n_objectives = std::min(n_objectives, pop[p].objectives.size());
+      for (size_t m = 0; m < n_objectives; ++m) {
+        std::vector<size_t> order = front;
+        std::sort(std::begin(order), std::end(order), [&](size_t lhs, size_t rhs) {
+            return pop[lhs].objectives[m] < pop[rhs].objectives[m];
+        });
+        const double range = pop[order.back()].objectives[m] - pop[order.front()].objectives[m];
+        pop[order.front()].crowding = pop[order.back()].crowding = std::numeric_limits<double>::infinity();
+        if(!(range > 0) || !std::isfinite(range)) continue;
+        for (size_t i = 1; i + 1 < order.size(); ++i) {
+          pop[order[i]].crowding += (pop[order[i+1]].objectives[m] - pop[order[i-1]].objectives[m]) / range;
+        }
+      }
+    }
+    return fronts;
+  }
+
+  /** \returns true if lhs is preferred by the crowded comparison operator */
+  bool crowded_less(individual const& lhs, individual const& rhs) {
+    return lhs.rank < rhs.rank || (lhs.rank == rhs.rank && lhs.crowding > rhs.crowding);
+  }
+}
+
+/**
+ * NSGA-II multi-objective search over every entry of opt:output.
+ *
+ * Each generation of offspring is evaluated concurrently, and the first non-dominated front of the
+ * final population is reported in the metrics so that operating points can be chosen after the search.
+ */
+struct nsga2_search: public pressio_search_plugin {
+  public:
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &token) override {
+      pressio_search_results results;
+      pareto_inputs.clear();
+      pareto_outputs.clear();
+      if(mode == pressio_search_mode_target && not target) {
+        results.status = 1;
+        results.msg = "nsga2 requires opt:target in target mode";
+        return results;
+      }
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
+      const size_t n_dims = search_lower.size();
+      auto last_time = std::chrono::system_clock::now();
+      auto max_time = std::chrono::system_clock::now() + std::chrono::seconds(max_seconds);
+      pressio_search_budget budget(time_budget);
+      pressio_search_feasibility feasibility(constraints);
+
+      auto from_unit = [&](std::vector<double> const& unit) {
+        pressio_search_results::input_type input(n_dims);
+        for (size_t dim = 0; dim < n_dims; ++dim) {
+          input[dim] = search_lower[dim] + unit[dim] * (search_upper[dim] - search_lower[dim]);
+          if(dim < is_integral.size() && is_integral[dim] && transform.is_linear(dim)) {
+            input[dim] = std::min(std::max(std::round(input[dim]), std::ceil(search_lower[dim])), std::floor(search_upper[dim]));
+          }
+        }
+        return input;
+      };
+      //orient each output so that smaller is better
+      auto objectives = [this](pressio_search_results::output_type const& output) {
+        std::vector<double> oriented(output.size());
+        for (size_t i = 0; i < output.size(); ++i) {
+          const unsigned int output_mode = (i < objective_modes.size()) ? objective_modes[i] : ((i == 0) ? mode : static_cast<unsigned int>(pressio_search_mode_min));
+          //only the first output has a target
+          const pressio_search_objective goal(output_mode, (i == 0) ? target : compat::optional<double>(), 0.0);
+          oriented[i] = goal.loss(output[i]);
+        }
+        return oriented;
+      };
+
+      size_t evaluations = 0;
+      auto is_stopped = [&]() {
+        return (evaluations >= max_iterations) ||
+          (max_seconds > 0 && (last_time = std::chrono::system_clock::now()) > max_time) ||
+          budget.expired() ||
+          token.stop_requested();
+      };
+      const size_t workers = (thread_safe) ? std::max(1u, nthreads) : 1;
+      //evaluates the individuals in [first, last) concurrently if possible
+      auto evaluate_all = [&](std::vector<individual>& pop, size_t first, size_t last) {
+        std::vector<std::exception_ptr> errors(last - first);
+        auto evaluate = [&](size_t i) {
+          try {
+            auto& member = pop[i];
+            member.input = from_unit(member.unit);
+            if(!feasibility.pruned(member.input)) {
+              member.output = compress_fn(member.input);
+              feasibility.record(member.input, member.output);
+            }
+          } catch(...) {
+            errors[i - first] = std::current_exception();
+          }
+        };
+        for (size_t begin = first; begin < last; begin += workers) {
+          if(workers > 1) {
+            std::vector<std::thread> threads;
+            for (size_t i = begin; i < std::min(begin + workers, last); ++i) {
+              threads.emplace_back(evaluate, i);
+            }
+            for (auto& thread : threads) {
+              thread.join();
+            }
+          } else {
+            evaluate(begin);
+          }
+        }
+        for (auto const& error : errors) {
+          if(error) std::rethrow_exception(error);
+        }
+        evaluations += last - first;
+        for (size_t i = first; i < last; ++i) {
+          auto& member = pop[i];
+          member.objectives = objectives(member.output);
+          member.violation = (member.output.empty()) ? std::numeric_limits<double>::infinity() : constraints.violation(member.output);
+        }
+      };
+
+      std::mt19937_64 gen(seed.value_or(time(nullptr)));
+      std::uniform_real_distribution<double> uniform(0.0, 1.0);
+      //an even population so that parents pair up
+      const size_t pop_size = std::max<size_t>(4, population + population % 2);
+      const size_t n_initial = std::min<size_t>(pop_size, max_iterations);
+      std::vector<individual> pop(n_initial);
+      const pressio_search_sequence design(pressio_search_sequence::kind::lhs, n_dims, n_initial, gen(), true);
+      for (size_t i = 0; i < n_initial; ++i) {
+        pop[i].unit = design.point(i);
+      }
+      evaluate_all(pop, 0, n_initial);
+      sort_fronts(pop);
+
+      std::vector<individual> offspring;
+      while(!is_stopped()) {
+        std::uniform_int_distribution<size_t> pick(0, pop.size() - 1);
+        auto tournament = [&]() -> individual const& {
+          auto const& lhs = pop[pick(gen)];
+          auto const& rhs = pop[pick(gen)];
+          return crowded_less(rhs, lhs) ? rhs : lhs;
+        };
+        const size_t n_offspring = std::min<size_t>(pop_size, max_iterations - evaluations);
+        offspring.assign(n_offspring, individual{});
+        for (size_t i = 0; i < n_offspring; i += 2) {
+          auto child1 = tournament().unit;
+          auto child2 = tournament().unit;
+          //simulated binary crossover
+          if(uniform(gen) < crossover) {
+            for (size_t dim = 0; dim < n_dims; ++dim) {
+              if(uniform(gen) > .5) continue;
+              const double u = uniform(gen);
+              const double beta = (u <= .5) ? std::pow(2.0 * u, 1.0 / (crossover_eta + 1.0)) : std::pow(1.0 / (2.0 * (1.0 - u)), 1.0 / (crossover_eta + 1.0));
+              const double x1 = child1[dim], x2 = child2[dim];
+              child1[dim] = .5 * ((1.0 + beta) * x1 + (1.0 - beta) * x2);
+              child2[dim] = .5 * ((1.0 - beta) * x1 + (1.0 + beta) * x2);
+            }
+          }
+          //polynomial mutation
+          for (auto* child : {&child1, &child2}) {
+            for (auto& value : *child) {
+              if(uniform(gen) >= 1.0 / static_cast<double>(n_dims)) continue;
+              const double u = uniform(gen);
+              value += (u < .5) ? std::pow(2.0 * u, 1.0 / (mutation_eta + 1.0)) - 1.0 : 1.0 - std::pow(2.0 * (1.0 - u), 1.0 / (mutation_eta + 1.0));
+            }
+            for (auto& value : *child) value = std::min(std::max(value, 0.0), 1.0);
+          }
+          offspring[i].unit = std::move(child1);
+          if(i + 1 < n_offspring) offspring[i + 1].unit = std::move(child2);
+        }
+        evaluate_all(offspring, 0, n_offspring);
+
+        //keep the best pop_size of the parents and offspring
+        std::move(std::begin(offspring), std::end(offspring), std::back_inserter(pop));
+        auto const fronts = sort_fronts(pop);
+        std::vector<individual> next;
+        next.reserve(pop_size);
+        for (auto const& front : fronts) {
+          if(next.size() + front.size() <= pop_size) {
+            for (auto p : front) next.push_back(std::move(pop[p]));
+          } else {
+            std::vector<size_t> order = front;
+            std::sort(std::begin(order), std::end(order), [&](size_t lhs, size_t rhs) { return pop[lhs].crowding > pop[rhs].crowding; });
+            for (size_t i = 0; next.size() < pop_size; ++i) next.push_back(std::move(pop[order[i]]));
+          }
+          if(next.size() >= pop_size) break;
+        }
+        pop = std::move(next);
+        sort_fronts(pop);
+      }
+
+      //report the first front, and the member of it that is best in the first objective as the result
+      individual const* best = nullptr;
+      for (auto const& member : pop) {
+        if(member.rank != 0 || member.violation > 0) continue;
+        auto const input = transform.from_search(member.input);
+        pareto_inputs.insert(std::end(pareto_inputs), std::begin(input), std::end(input));
+        pareto_outputs.insert(std::end(pareto_outputs), std::begin(member.output), std::end(member.output));
+        if(best == nullptr || member.objectives.front() < best->objectives.front()) {
+          best = &member;
+        }
+      }
+      pareto_dims = {n_dims, (best) ? best->output.size() : 0};
+
+      if(best == nullptr) {
+        results.status = -3;
+        results.msg = "no feasible point found";
+      } else {
+        results.inputs = transform.from_search(best->input);
+        results.output = best->output;
+        if(last_time > max_time || budget.expired()) {
+          results.status = -2;
+          results.msg = "time-limit exceeded";
+        }
+      }
+      return results;
+    }
+
+    pressio_options get_metrics_results() const override {
+      pressio_options metrics;
+      const size_t n_points = (pareto_dims.first) ? pareto_inputs.size() / pareto_dims.first : 0;
+      auto inputs = pressio_data::owning(pressio_double_dtype, {pareto_dims.first, n_points});
+      std::copy(std::begin(pareto_inputs), std::end(pareto_inputs), static_cast<double*>(inputs.data()));
+      auto outputs = pressio_data::owning(pressio_double_dtype, {pareto_dims.second, n_points});
+      std::copy(std::begin(pareto_outputs), std::end(pareto_outputs), static_cast<double*>(outputs.data()));
+      set(metrics, "nsga2:pareto_inputs", inputs);
+      set(metrics, "nsga2:pareto_outputs", outputs);
+      return metrics;
+    }
+
+    //configuration
+    pressio_options get_options() const override {
+      pressio_options opts;
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      std::vector<uint8_t> is_integral_u8(is_integral.begin(), is_integral.end());
+      set(opts, "opt:is_integral", pressio_data(std::begin(is_integral_u8), std::end(is_integral_u8)));
+      set(opts, "opt:max_iterations", max_iterations);
+      set(opts, "opt:max_seconds", max_seconds);
+      set(opts, "opt:target", target);
+      set(opts, "opt:objective_mode", mode);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "opt:transform", transform.names());
+      set(opts, "nsga2:objective_modes", pressio_data(std::begin(objective_modes), std::end(objective_modes)));
+      set(opts, "nsga2:nthreads", nthreads);
+      set(opts, "nsga2:population", population);
+      set(opts, "nsga2:crossover", crossover);
+      set(opts, "nsga2:crossover_eta", crossover_eta);
+      set(opts, "nsga2:mutation_eta", mutation_eta);
+      set(opts, "nsga2:seed", seed);
+      return opts;
+    }
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:is_integral", &data) == pressio_options_key_set) {
+        auto is_integral_u8 = data.to_vector<uint8_t>();
+        is_integral = std::vector<bool>(is_integral_u8.begin(), is_integral_u8.end());
+      }
+      get(options, "opt:max_iterations", &max_iterations);
+      get(options, "opt:max_seconds", &max_seconds);
+      get(options, "opt:target", &target);
+      get(options, "opt:objective_mode", &mode);
+      get(options, "opt:time_budget", &time_budget);
+      get(options, "opt:thread_safe", &thread_safe);
+      if(get(options, "nsga2:objective_modes", &data) == pressio_options_key_set) {
+        objective_modes = data.to_vector<unsigned int>();
+      }
+      get(options, "nsga2:nthreads", &nthreads);
+      get(options, "nsga2:population", &population);
+      get(options, "nsga2:crossover", &crossover);
+      get(options, "nsga2:crossover_eta", &crossover_eta);
+      get(options, "nsga2:mutation_eta", &mutation_eta);
+      get(options, "nsga2:seed", &seed);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      return 0;
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "nsga2";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<nsga2_search>(*this);
+    }
+
+private:
+    pressio_search_results::input_type lower_bound{};
+    pressio_search_results::input_type upper_bound{};
+    std::vector<bool> is_integral{};
+    compat::optional<pressio_search_results::output_type::value_type> target{};
+    std::vector<unsigned int> objective_modes;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    unsigned int max_iterations = 100;
+    unsigned int max_seconds = 0;
+    double time_budget = std::numeric_limits<double>::max();
+    unsigned int mode = pressio_search_mode_min;
+    unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int population = 20;
+    double crossover = .9;
+    double crossover_eta = 15;
+    double mutation_eta = 20;
+    compat::optional<unsigned int> seed;
+    int thread_safe = 0;
+
+    //the first front of the last search, in the opt:evaluations layout of [width, n_points]
+    std::vector<double> pareto_inputs;
+    std::vector<double> pareto_outputs;
+    std::pair<size_t, size_t> pareto_dims{0, 0};
+};
+
+
+static pressio_register nsga2_register(search_plugins(), "nsga2", [](){ return compat::make_unique<nsga2_search>();});
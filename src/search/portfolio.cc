@@ -0,0 +1,354 @@
+#include "pressio_search.h"
+#include "pressio_search_results.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_mailbox.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <mpi.h>
+#include <std_compat/memory.h>
+
+namespace {
+  /**
+   * stop token shared by all of the children of the portfolio; stopping one
+   * child stops all of them and is forwarded to the parent
+   */
+  class PortfolioStopToken: public distributed::queue::StopToken {
+    public:
+    PortfolioStopToken(distributed::queue::StopToken& parent, pressio_search_budget const& budget):
+      parent(parent), budget(budget) {}
+
+    bool stop_requested() override {
+      if(should_stop || budget.expired()) return true;
+      std::lock_guard<std::mutex> guard(parent_mutex);
+      return parent.stop_requested();
+    }
+
+    void request_stop() override {
+      should_stop = true;
+      std::lock_guard<std::mutex> guard(parent_mutex);
+      parent.request_stop();
+    }
+
+    private:
+    std::atomic<bool> should_stop{false};
+    std::mutex parent_mutex;
+    distributed::queue::StopToken& parent;
+    pressio_search_budget const& budget;
+  };
+
+  /**
+   * splits the ranks of the portfolio into one group per child, or one group per rank when there
+   * are more children than ranks, and gives each child of this rank's group its own communicator
+   * so that children that run concurrently never share one.
+   *
+   * Construction is collective over the parent communicator.
+   */
+  class PortfolioGroup {
+    public:
+    PortfolioGroup(MPI_Comm parent, size_t n_children) {
+      int rank, size;
+      MPI_Comm_rank(parent, &rank);
+      MPI_Comm_size(parent, &size);
+      const size_t n_groups = std::min<size_t>(n_children, size);
+      const size_t group = static_cast<size_t>(rank) % n_groups;
+      MPI_Comm group_comm;
+      MPI_Comm_split(parent, static_cast<int>(group), rank, &group_comm);
+      for (size_t i = group; i < n_children; i += n_groups) {
+        children.push_back(i);
+        comms.emplace_back();
+        MPI_Comm_dup(group_comm, &comms.back());
+      }
+      MPI_Comm_free(&group_comm);
+    }
+    PortfolioGroup(PortfolioGroup const&)=delete;
+    PortfolioGroup& operator=(PortfolioGroup const&)=delete;
+    ~PortfolioGroup() {
+      for (auto& comm : comms) {
+        MPI_Comm_free(&comm);
+      }
+    }
+
+    /** the indices of the children run by this group */
+    std::vector<size_t> children;
+    /** the communicator of each child run by this group */
+    std::vector<MPI_Comm> comms;
+  };
+}
+
+struct portfolio_search: public pressio_search_plugin {
+  public:
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &stop_token) override {
+      pressio_search_results results;
+      if(plugins.empty()) {
+        results.status = 1;
+        results.msg = "portfolio was not configured with any searches";
+        return results;
+      }
+
+      pressio_search_budget budget(time_budget);
+      PortfolioStopToken token(stop_token, budget);
+      pressio_search_cache cache(compress_fn);
+      auto shared_compress_fn = [&cache, &token, this](pressio_search_results::input_type const& input) {
+        auto output = cache(input);
+        if(is_achieved(output)) {
+          token.request_stop();
+        }
+        return output;
+      };
+
+      //the groups reduce their results on the portfolio's communicator
+      pressio_search_mailbox mailbox(comm);
+      PortfolioGroup group(comm, plugins.size());
+      const size_t n_children = group.children.size();
+      std::vector<pressio_search_results> child_results(n_children);
+      std::vector<std::exception_ptr> errors(n_children);
+      auto run_child = [&](size_t j) {
+        auto const& plugin = plugins[group.children[j]];
+        try {
+          pressio_search_options_guard restore(plugin);
+          restore.restore("distributed:comm", (void*)comm);
+          pressio_options child_options;
+          child_options.set("distributed:comm", (void*)group.comms[j]);
+          if(budget.limited()) {
+            //children that run concurrently can each use all of what remains,
+            //children that run in turn split it
+            child_options.set("opt:time_budget", (thread_safe) ? budget.remaining() : budget.share(n_children - j));
+          }
+          plugin->set_options(child_options);
+          child_results[j] = plugin->search(input_datas, shared_compress_fn, token);
+        } catch(...) {
+          errors[j] = std::current_exception();
+          token.request_stop();
+        }
+      };
+      if(thread_safe) {
+        std::vector<std::thread> threads;
+        threads.reserve(n_children);
+        for (size_t j = 0; j < n_children; ++j) {
+          threads.emplace_back(run_child, j);
+        }
+        for (auto& thread : threads) {
+          thread.join();
+        }
+      } else {
+        //the compressor is not thread safe, so run each search in turn
+        for (size_t j = 0; j < n_children && !token.stop_requested(); ++j) {
+          run_child(j);
+        }
+      }
+      const bool local_error = std::any_of(std::begin(errors), std::end(errors),
+          [](std::exception_ptr const& error) { return static_cast<bool>(error); });
+      if(mailbox.any(local_error)) {
+        for (auto const& error : errors) {
+          if(error) std::rethrow_exception(error);
+        }
+        throw std::runtime_error("a search of the portfolio failed on another rank");
+      }
+
+      //choose the best point found by any of the children on any rank
+      auto history = cache.history();
+      auto best = std::end(history);
+      for (auto it = std::begin(history); it != std::end(history); ++it) {
+        if(it->second.empty() || !constraints.feasible(it->second)) continue;
+        if(best == std::end(history) || is_better(it->second.front(), best->second.front())) {
+          best = it;
+        }
+      }
+      const bool found = best != std::end(history);
+      const int best_rank = mailbox.best_rank((found) ? goal().loss(best->second.front()) : std::numeric_limits<double>::infinity());
+      if(!mailbox.any(found)) {
+        auto failed = std::find_if(std::begin(child_results), std::end(child_results),
+            [](pressio_search_results const& result) { return result.status != 0; });
+        results = (failed != std::end(child_results)) ? *failed : child_results.front();
+        if(!constraints.empty() && results.status == 0) {
+          results.status = -3;
+          results.msg = "no feasible point found";
+        }
+        return results;
+      }
+      if(found) {
+        results.inputs = best->first;
+        results.output = best->second;
+      }
+      mailbox.bcast(results.inputs, best_rank);
+      mailbox.bcast(results.output, best_rank);
+      if(!is_achieved(results.output) && mailbox.any(budget.expired())) {
+        results.status = -2;
+        results.msg = "time-limit exceeded";
+      }
+      return results;
+    }
+
+    //configuration
+    pressio_options get_options() const override {
+      pressio_options opts;
+      set(opts, "portfolio:search", search_methods);
+      set(opts, "portfolio:names", search_names);
+      set(opts, "opt:target", target);
+      set(opts, "opt:objective_mode", mode);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      for (auto const& plugin : plugins) {
+        auto plugin_options = plugin->get_options();
+        for(auto const& plugin_option : plugin_options) {
+          opts.set(plugin_option.first, plugin_option.second);
+        }
+      }
+      return opts;
+    }
+
+    int set_options(pressio_options const& options) override {
+      std::vector<std::string> tmp_search_methods;
+      if(get(options, "portfolio:search", &tmp_search_methods) == pressio_options_key_set) {
+        if(tmp_search_methods != search_methods) {
+          std::vector<pressio_search> new_plugins;
+          new_plugins.reserve(tmp_search_methods.size());
+          for (auto const& new_plugin_id : tmp_search_methods) {
+            new_plugins.emplace_back(search_plugins().build(new_plugin_id));
+            if(not new_plugins.back()) {
+              return set_error(1, std::string("failed to load search plugin: ") + new_plugin_id);
+            }
+          }
+          search_methods = std::move(tmp_search_methods);
+          plugins = std::move(new_plugins);
+          if(not get_name().empty()) {
+            set_name(get_name());
+          }
+        }
+      }
+
+      std::vector<std::string> tmp_search_names;
+      if(get(options, "portfolio:names", &tmp_search_names) == pressio_options_key_set) {
+        if(tmp_search_names.size() > 0 && tmp_search_names.size() != plugins.size()) {
+          return set_error(2, "invalid number of names");
+        }
+        search_names = std::move(tmp_search_names);
+        if(not get_name().empty()) {
+          set_name(get_name());
+        }
+      }
+
+      get(options, "opt:target", &target);
+      get(options, "opt:objective_mode", &mode);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:time_budget", &time_budget);
+      get(options, "opt:thread_safe", &thread_safe);
+      void* comm_ptr = nullptr;
+      if(get(options, "distributed:mpi_comm", &comm_ptr) == pressio_options_key_set && comm_ptr != nullptr) {
+        comm = (MPI_Comm)comm_ptr;
+      }
+      if(get(options, "distributed:comm", &comm_ptr) == pressio_options_key_set && comm_ptr != nullptr) {
+        comm = (MPI_Comm)comm_ptr;
+      }
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+
+      for (auto& plugin : plugins) {
+        int ret = plugin->set_options(options);
+        if(ret) {
+          return set_error(ret, plugin->error_msg());
+        }
+      }
+      return 0;
+    }
+
+    pressio_options get_metrics_results() const override {
+      pressio_options metrics;
+      for (auto const& plugin : plugins) {
+        metrics.copy_from(plugin->get_metrics_results());
+      }
+      return metrics;
+    }
+
+    void set_name_impl(std::string const& new_name) override {
+      for (size_t i = 0; i < plugins.size(); ++i) {
+        auto const child_name = (search_names.size() == plugins.size()) ? search_names[i] : std::string(plugins[i]->prefix());
+        plugins[i]->set_name(new_name + "/" + child_name);
+      }
+    }
+
+    std::vector<std::string> children() const final override {
+      std::vector<std::string> names;
+      std::transform(std::begin(plugins), std::end(plugins), std::back_inserter(names),
+          [](pressio_search const& plugin) { return plugin->get_name(); });
+      return names;
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "portfolio";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<portfolio_search>(*this);
+    }
+
+private:
+    /** \returns the objective of the search */
+    pressio_search_objective goal() const {
+      return pressio_search_objective(mode, target, global_rel_tolerance);
+    }
+
+    /** \returns true if output is feasible and meets the target for the current mode */
+    bool is_achieved(pressio_search_results::output_type const& output) const {
+      return !output.empty() && constraints.feasible(output) && goal().is_achieved(output.front());
+    }
+
+    /** \returns true if lhs is a better objective than rhs for the current mode */
+    bool is_better(double lhs, double rhs) const {
+      auto const objective = goal();
+      return objective.loss(lhs) < objective.loss(rhs);
+    }
+
+    std::vector<std::string> search_methods;
+    std::vector<std::string> search_names;
+    std::vector<pressio_search> plugins;
+    compat::optional<pressio_search_results::output_type::value_type> target;
+    unsigned int mode = pressio_search_mode_target;
+    double global_rel_tolerance = .1;
+    double time_budget = std::numeric_limits<double>::max();
+    pressio_search_constraints constraints;
+    int thread_safe = 0;
+    MPI_Comm comm = MPI_COMM_WORLD;
+};
+
+
+static pressio_register portfolio_register(search_plugins(), "portfolio", [](){ return compat::make_unique<portfolio_search>();});
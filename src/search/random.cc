@@ -1,12 +1,16 @@
 #include "pressio_search.h"
 #include "pressio_search_defines.h"
 #include "pressio_search_results.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_transform.h"
+#include "pressio_search_sequence.h"
 #include <algorithm>
 #include <chrono>
 #include <iterator>
 #include <libdistributed_work_queue.h>
 #include <limits>
-#include <random>
 #include <time.h>
 #include <mpi.h>
 #include <std_compat/memory.h>
@@ -19,6 +23,59 @@ loss(pressio_search_results::output_type::value_type target,
 {
   return std::abs(target - actual);
 }
+
+/**
+ * generates the points of the search as the work queue requests them so that
+ * memory use does not depend on the number of iterations
+ */
+class point_iterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::tuple<std::vector<double>>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = value_type const*;
+  using reference = value_type const&;
+
+  point_iterator(pressio_search_sequence const& sequence,
+                 pressio_search_results::input_type const& lower,
+                 pressio_search_results::input_type const& upper,
+                 uint64_t index)
+    : sequence(&sequence), lower(&lower), upper(&upper), index(index)
+  {
+  }
+
+  reference operator*() const
+  {
+    auto point = sequence->point(index);
+    for (size_t dim = 0; dim < point.size(); ++dim) {
+      point[dim] = (*lower)[dim] + point[dim] * ((*upper)[dim] - (*lower)[dim]);
+    }
+    current = value_type{ std::move(point) };
+    return current;
+  }
+  pointer operator->() const { return &**this; }
+  point_iterator& operator++()
+  {
+    ++index;
+    return *this;
+  }
+  point_iterator operator++(int)
+  {
+    point_iterator tmp = *this;
+    ++index;
+    return tmp;
+  }
+  bool operator==(point_iterator const& rhs) const { return index == rhs.index; }
+  bool operator!=(point_iterator const& rhs) const { return index != rhs.index; }
+
+private:
+  pressio_search_sequence const* sequence;
+  pressio_search_results::input_type const* lower;
+  pressio_search_results::input_type const* upper;
+  uint64_t index;
+  mutable value_type current;
+};
 } // namespace
 
 struct random_search : public pressio_search_plugin
@@ -56,93 +113,134 @@ public:
       best_results.msg = "at least 1 iterations are required";
       return best_results;
     }
+    auto const search_lower = transform.to_search(lower_bound);
+    auto const search_upper = transform.to_search(upper_bound);
+    if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+      best_results.status = 1;
+      best_results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+      return best_results;
+    }
+    compress_fn = transform.wrap(std::move(compress_fn));
 
-    std::seed_seq seed_s {seed.value_or(time(nullptr))};
-    std::default_random_engine gen{seed_s};
-
-    auto point_generator = [this, &gen]() {
-      using value_type = pressio_search_results::input_type::value_type;
-      pressio_search_results::input_type input(this->lower_bound.size());
-      std::transform(std::begin(this->lower_bound), std::end(this->lower_bound),
-                     std::begin(this->upper_bound), std::begin(input),
-                     [&gen](value_type lower, value_type upper) {
-                       std::uniform_real_distribution<value_type> dist(lower,
-                                                                       upper);
-                       return dist(gen);
-                     });
-      return task_request_t{ std::move(input) };
-    };
-
-    std::vector<task_request_t> inital_points;
-    inital_points.reserve(max_iterations);
-    std::generate_n(std::back_inserter(inital_points), max_iterations,
-                    point_generator);
+    pressio_search_sequence::kind kind;
+    if (pressio_search_sequence::parse(generator, kind) ||
+        search_lower.size() > pressio_search_sequence::max_dims(kind)) {
+      best_results.status = 1;
+      best_results.msg = "random:generator " + generator + " does not support " +
+                         std::to_string(search_lower.size()) + " inputs";
+      return best_results;
+    }
+    //sobol and halton are only randomized if a seed is provided
+    const pressio_search_sequence sequence(kind, search_lower.size(), max_iterations,
+                                           seed.value_or(time(nullptr)), bool(seed));
+    const point_iterator points_begin(sequence, search_lower, search_upper, 0);
+    const point_iterator points_end(sequence, search_lower, search_upper, max_iterations);
 
     auto start_time = std::chrono::system_clock::now();
-    auto should_stop = [this, &token, start_time]() {
+    pressio_search_budget budget(time_budget);
+    auto should_stop = [this, &token, start_time, &budget]() {
       auto current_time = std::chrono::system_clock::now();
-      return token.stop_requested() ||
+      return token.stop_requested() || budget.expired() ||
              std::chrono::duration_cast<std::chrono::seconds>(current_time -
                                                               start_time)
                  .count() > max_seconds;
     };
 
-    manager.work_queue(
-      std::begin(inital_points), std::end(inital_points),
-      [&compress_fn](task_request_t const& request) {
-        auto const& inputs = std::get<0>(request);
-        pressio_search_results::output_type result = compress_fn(inputs);
-        return task_response_t{ inputs, result };
-      },
-      [&best_results, &best_objective, &token, &should_stop,
-       this](task_response_t response,
-             distributed::queue::TaskManager<task_request_t, MPI_Comm>& task_manager) {
-        const auto& inputs = std::get<0>(response);
-        const auto& objective = std::get<1>(response).front();
-
-        switch (mode) {
-          case pressio_search_mode_max:
-            if (objective > best_objective) {
-              best_objective = objective;
-              best_results.output = std::get<1>(response);
-              best_results.inputs = inputs;
-              if(target && objective > *target) {
-                task_manager.request_stop();
-                token.request_stop();
-              }
-            }
-            break;
-          case pressio_search_mode_min:
-            if (objective < best_objective) {
-              best_objective = objective;
-              best_results.output = std::get<1>(response);
-              best_results.inputs = inputs;
-              if(target && objective < *target) {
-                task_manager.request_stop();
-                token.request_stop();
-              }
-            }
-            break;
-          case pressio_search_mode_target:
-            if (loss(*target, objective) < best_objective) {
-              best_results.output = std::get<1>(response);
-              best_results.inputs = inputs;
-              best_objective = loss(*target, objective);
-              if (best_objective <
-                    loss(*target * (1.0 + global_rel_tolerance), *target) ||
-                  best_objective <
-                    loss(*target * (1.0 - global_rel_tolerance), *target)) {
-                token.request_stop();
-                task_manager.request_stop();
-              }
+    pressio_search_history priors;
+    try {
+      priors = evaluations_to_history(transform.evaluations_to_search(evaluations_data, search_lower.size()), search_lower.size());
+    } catch(std::runtime_error const& err) {
+      best_results.status = -1;
+      best_results.msg = err.what();
+      return best_results;
+    }
+
+    //keeps the evaluation if it is the best so far, and returns true if it meets the target
+    auto update = [&best_results, &best_objective, this](pressio_search_results::input_type const& inputs,
+                                                         pressio_search_results::output_type const& output) {
+      const auto& objective = output.front();
+      switch (mode) {
+        case pressio_search_mode_max:
+          if (objective > best_objective) {
+            best_objective = objective;
+            best_results.output = output;
+            best_results.inputs = inputs;
+            return target && objective > *target;
+          }
+          break;
+        case pressio_search_mode_min:
+          if (objective < best_objective) {
+            best_objective = objective;
+            best_results.output = output;
+            best_results.inputs = inputs;
+            return target && objective < *target;
+          }
+          break;
+        case pressio_search_mode_target:
+          if (loss(*target, objective) < best_objective) {
+            best_results.output = output;
+            best_results.inputs = inputs;
+            best_objective = loss(*target, objective);
+            return best_objective <
+                     loss(*target * (1.0 + global_rel_tolerance), *target) ||
+                   best_objective <
+                     loss(*target * (1.0 - global_rel_tolerance), *target);
+          }
+          break;
+      }
+      return false;
+    };
+
+    //prior evaluations only carry the objective, so they are taken as feasible, see seed_evaluations;
+    //every rank has the same priors, so every rank skips the work queue if one meets the target
+    bool prior_achieved = false;
+    for (auto const& prior : priors) {
+      prior_achieved = update(prior.first, prior.second) || prior_achieved;
+    }
+    if (prior_achieved) {
+      token.request_stop();
+    }
+
+    pressio_search_feasibility feasibility(constraints);
+    if (!prior_achieved) {
+      manager.work_queue(
+        points_begin, points_end,
+        [&compress_fn, &feasibility](task_request_t const& request) {
+          auto const& inputs = std::get<0>(request);
+          //skip points that are known to be infeasible
+          if(feasibility.pruned(inputs)) {
+            return task_response_t{ inputs, {} };
+          }
+          pressio_search_results::output_type result = compress_fn(inputs);
+          feasibility.record(inputs, result);
+          return task_response_t{ inputs, result };
+        },
+        [&update, &token, &should_stop,
+         this](task_response_t response,
+               distributed::queue::TaskManager<task_request_t, MPI_Comm>& task_manager) {
+          const auto& inputs = std::get<0>(response);
+          if (std::get<1>(response).empty() || !constraints.feasible(std::get<1>(response))) {
+            if (should_stop()) {
+              task_manager.request_stop();
             }
-            break;
-        }
+            return;
+          }
+          if (update(inputs, std::get<1>(response))) {
+            token.request_stop();
+            task_manager.request_stop();
+          }
 
-        if (should_stop()) {
-          task_manager.request_stop();
-        }
-      });
+          if (should_stop()) {
+            task_manager.request_stop();
+          }
+        });
+    }
+
+    if (!constraints.empty() && best_results.output.empty()) {
+      best_results.status = -3;
+      best_results.msg = "no feasible point found";
+    }
+    best_results.inputs = transform.from_search(best_results.inputs);
 
     manager.bcast(best_results.inputs);
     manager.bcast(best_results.output);
@@ -164,8 +262,14 @@ public:
     set(opts, "opt:max_seconds", max_seconds);
     set(opts, "opt:target", target);
     set(opts, "opt:objective_mode", mode);
+    set(opts, "opt:evaluations", evaluations_data);
     opts.copy_from(manager.get_options());
     set(opts,"random:seed", seed);
+    set(opts, "random:generator", generator);
+    set(opts, "opt:time_budget", time_budget);
+    set(opts, "opt:transform", transform.names());
+    set(opts, "opt:constraints", constraints.constraints());
+    set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
     return opts;
   }
   int set_options(pressio_options const& options) override
@@ -183,8 +287,26 @@ public:
     options.get("opt:max_seconds", &max_seconds);
     options.get("opt:target", &target);
     options.get("opt:objective_mode", &mode);
+    options.get("opt:evaluations", &evaluations_data);
     manager.set_options(options);
     options.get("random:seed", &seed);
+    std::string tmp_generator;
+    pressio_search_sequence::kind kind;
+    if (get(options, "random:generator", &tmp_generator) == pressio_options_key_set) {
+      if (pressio_search_sequence::parse(tmp_generator, kind)) {
+        return set_error(1, "unknown random:generator: " + tmp_generator);
+      }
+      generator = std::move(tmp_generator);
+    }
+    options.get("opt:time_budget", &time_budget);
+    std::string transform_err;
+    if(transform.set_options(options, get_name(), transform_err)) {
+      return set_error(1, transform_err);
+    }
+    std::string constraints_err;
+    if (constraints.set_options(options, get_name(), constraints_err)) {
+      return set_error(1, constraints_err);
+    }
     return 0;
   }
 
@@ -222,10 +344,15 @@ private:
   pressio_search_results::input_type lower_bound;
   pressio_search_results::input_type upper_bound;
   compat::optional<pressio_search_results::output_type::value_type> target;
+  pressio_data evaluations_data;
   unsigned int max_iterations = 100;
   unsigned int max_seconds = std::numeric_limits<unsigned int>::max();
+  double time_budget = std::numeric_limits<double>::max();
+  pressio_search_constraints constraints;
+  pressio_search_transform transform;
   unsigned int mode = pressio_search_mode_none;
   compat::optional<unsigned int> seed;
+  std::string generator = "uniform";
   pressio_distributed_manager manager = pressio_distributed_manager(
       /*max_masters*/1,
       /*max_ranks_per_worker*/1
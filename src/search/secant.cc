@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include "pressio_search.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_transform.h"
+#include "pressio_search_evaluations.h"
+#include <std_compat/std_compat.h>
+#include <std_compat/memory.h>
+
+/**
+ * finds an input that achieves a target for a monotone objective with a single input using the
+ * Illinois variant of regula falsi which takes secant steps within a bracket of the target.
+ *
+ * When the bracket does not at least halve every secant:safeguard_steps steps, a bisection step is taken
+ * so the search never converges much slower than binary search.
+ */
+struct secant_search: public pressio_search_plugin {
+  public:
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &token) override {
+      pressio_search_results results;
+      size_t iter = 0;
+      auto last_time = std::chrono::system_clock::now();
+      auto max_time = std::chrono::system_clock::now() + std::chrono::seconds(max_seconds);
+      pressio_search_budget budget(time_budget);
+      if(not target) {
+        results.status = 1;
+        results.msg = "secant requires opt:target";
+        return results;
+      }
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
+
+      //evaluations at the bounds may already be known
+      pressio_search_history history;
+      try {
+        history = evaluations_to_history(transform.evaluations_to_search(evaluations_data, 1), 1);
+      } catch(std::runtime_error const& err) {
+        results.status = -1;
+        results.msg = err.what();
+        return results;
+      }
+      compat::optional<double> best_input;
+      pressio_search_results::output_type best_result_v;
+      bool best_feasible = false;
+      auto evaluate = [&](double input, bool use_history) {
+        auto it = history.find({input});
+        if(use_history && it != history.end()) {
+          return it->second;
+        }
+        ++iter;
+        auto result_v = compress_fn({input});
+        const bool feasible = constraints.feasible(result_v);
+        if(not best_input || (feasible && !best_feasible) ||
+           (feasible == best_feasible && std::abs(result_v.front() - *target) < std::abs(best_result_v.front() - *target))) {
+          best_input = input;
+          best_result_v = result_v;
+          best_feasible = feasible;
+        }
+        return result_v;
+      };
+      auto is_achieved = [&](pressio_search_results::output_type const& result_v) {
+        return std::abs(result_v.front() - *target) <= std::abs(*target * global_rel_tolerance) &&
+          constraints.feasible(result_v);
+      };
+      auto is_stopped = [&]() {
+        return (iter >= max_iterations) || //exceeded maximum iterations
+          (max_seconds > 0 && (last_time = std::chrono::system_clock::now()) > max_time) || //check for time exceeded
+          budget.expired() || //check for the time budget of the entire search
+          token.stop_requested();
+      };
+
+      double a = search_lower.front();
+      double b = search_upper.front();
+      double current = a;
+      auto result_a = evaluate(a, true);
+      auto result_b = result_a;
+      auto current_v = result_a;
+      bool done = is_achieved(result_a);
+      if(!done && !is_stopped()) {
+        result_b = evaluate(b, true);
+        done = is_achieved(result_b);
+        if(done) {
+          current = b;
+          current_v = result_b;
+        }
+      }
+
+      //orient the objective so that it is negative at a and positive at b
+      const double sign = (result_a.front() <= result_b.front()) ? 1.0 : -1.0;
+      double ya = sign * (result_a.front() - *target);
+      double yb = sign * (result_b.front() - *target);
+      //ya and yb are halved by the Illinois modification, so monotonicity is checked against the unhalved values
+      double fa = ya, fb = yb;
+      const bool is_bracketed = ya <= 0 && 0 <= yb;
+      const double infeasible_direction = (constraints.monotone().empty()) ? 0.0 : constraints.monotone().front();
+
+      bool is_nonmonotonic = false;
+      //widths[i] is the width of the interval i steps ago
+      std::vector<double> widths{b - a};
+      int last_side = 0;
+      while(!done && is_bracketed && a < b && !is_stopped()) {
+        const double x_half = (a + b) / 2.0;
+        if(widths.size() > safeguard_steps && (b - a) > widths[widths.size() - 1 - safeguard_steps] / 2.0) {
+          //the secant steps are not converging faster than bisection would, so bisect
+          current = x_half;
+          widths.assign(1, b - a);
+        } else {
+          current = (yb == ya) ? x_half : (yb * a - ya * b) / (yb - ya);
+          if(!(a < current && current < b)) current = x_half;
+        }
+
+        current_v = evaluate(current, false);
+        if(is_achieved(current_v)) {
+          done = true;
+          break;
+        }
+        const double y = sign * (current_v.front() - *target);
+        if(infeasible_direction != 0 && !constraints.feasible(current_v)) {
+          //every input beyond current in this direction is also infeasible
+          if(infeasible_direction > 0) {
+            b = current;
+          } else {
+            a = current;
+          }
+          last_side = 0;
+        } else if(y < fa || y > fb) {
+          //check for non-monotonic results, violation of assumptions
+          is_nonmonotonic = true;
+          break;
+        } else if(y > 0) {
+          b = current;
+          yb = fb = y;
+          //Illinois modification: halve the stale end point to avoid one-sided convergence
+          if(last_side > 0) ya /= 2.0;
+          last_side = 1;
+        } else if (y < 0) {
+          a = current;
+          ya = fa = y;
+          if(last_side < 0) yb /= 2.0;
+          last_side = -1;
+        } else {
+          done = true;
+        }
+        widths.push_back(b - a);
+      }
+
+      if(done) {
+        token.request_stop();
+        results.inputs = transform.from_search({current});
+        results.output = current_v;
+        return results;
+      }
+
+      if(!is_bracketed) {
+        results.status = -4;
+        results.msg = "target is not between the objective at the bounds";
+      }
+      if(is_nonmonotonic) {
+        results.status = 1;
+        results.msg = "secant search objective function was non-monotonic, violation of assumptions";
+      }
+      if(iter >= max_iterations) {
+        results.status = -1;
+        results.msg = "iterations exceeded";
+      }
+      if(last_time > max_time || budget.expired()) {
+        results.status = -2;
+        results.msg = "time-limit exceeded";
+      }
+      if(best_input) {
+        //return the best so far if we stopped early
+        results.inputs = transform.from_search({*best_input});
+        results.output = best_result_v;
+        if(!best_feasible) {
+          results.status = -3;
+          results.msg = "no feasible point found";
+        }
+      } else {
+        //only the evaluations provided by the user were used
+        const bool use_b = std::abs(result_b.front() - *target) < std::abs(result_a.front() - *target);
+        results.inputs = transform.from_search({use_b ? b : a});
+        results.output = use_b ? result_b : result_a;
+      }
+
+      return results;
+    }
+
+    //configuration
+    pressio_options get_options() const override {
+      pressio_options opts;
+
+      //need to reconfigure because input size has changed
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      set(opts, "opt:max_iterations", max_iterations);
+      set(opts, "opt:max_seconds", max_seconds);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:target", target);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:transform", transform.names());
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "secant:safeguard_steps", safeguard_steps);
+      return opts;
+    }
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+        if(lower_bound.size() != 1) return set_error(1, "secant only supports a single input");
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+        if(upper_bound.size() != 1) return set_error(1, "secant only supports a single input");
+      }
+      get(options, "opt:max_iterations", &max_iterations);
+      get(options, "opt:max_seconds", &max_seconds);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:target", &target);
+      get(options, "opt:evaluations", &evaluations_data);
+      get(options, "opt:time_budget", &time_budget);
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      get(options, "secant:safeguard_steps", &safeguard_steps);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      return 0;
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "secant";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<secant_search>(*this);
+    }
+
+private:
+    pressio_search_results::input_type lower_bound{0.0};
+    pressio_search_results::input_type upper_bound{1.0};
+    compat::optional<pressio_search_results::output_type::value_type> target;
+    pressio_data evaluations_data;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    double global_rel_tolerance = .1;
+    unsigned int max_iterations = 100;
+    unsigned int max_seconds = 0;
+    double time_budget = std::numeric_limits<double>::max();
+    unsigned int safeguard_steps = 2;
+};
+
+
+static pressio_register secant_search_register(search_plugins(), "secant", [](){ return compat::make_unique<secant_search>();});
@@ -0,0 +1,382 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <time.h>
+#include "pressio_search.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_results.h"
+#include "pressio_search_budget.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_sequence.h"
+#include "pressio_search_transform.h"
+#include <std_compat/memory.h>
+
+namespace {
+  /**
+   * a product of one dimensional Parzen estimators over [0,1]^n_dims with a uniform prior component
+   */
+  class parzen_estimator {
+    public:
+    parzen_estimator(std::vector<std::vector<double> const*> points, size_t n_dims):
+      points(std::move(points)),
+      //Scott's rule for the unit interval, so the cost stays linear in the number of points
+      bandwidth(std::max(.01, std::pow(static_cast<double>(this->points.size() + 1), -1.0 / (n_dims + 4))))
+    {}
+
+    /** draws a point near a random member of the estimator, or uniformly if there are none */
+    std::vector<double> sample(std::mt19937_64& gen, size_t n_dims) const {
+      std::uniform_real_distribution<double> uniform(0.0, 1.0);
+      std::uniform_int_distribution<size_t> component(0, points.size());
+      const size_t idx = component(gen);
+      std::vector<double> x(n_dims);
+      if(idx == points.size()) {
+        for (auto& value : x) value = uniform(gen);
+        return x;
+      }
+      std::normal_distribution<double> step(0.0, bandwidth);
+      for (size_t dim = 0; dim < n_dims; ++dim) {
+        double value;
+        do {
+          value = (*points[idx])[dim] + step(gen);
+        } while(value < 0.0 || value > 1.0);
+        x[dim] = value;
+      }
+      return x;
+    }
+
+    /** \returns the log density of the estimator at x */
+    double log_density(std::vector<double> const& x) const {
+      const double weight = 1.0 / static_cast<double>(points.size() + 1);
+      double total = 0;
+      for (size_t dim = 0; dim < x.size(); ++dim) {
+        //the uniform prior keeps the density positive everywhere
+        double density = weight;
+        for (auto const* point : points) {
+          const double z = (x[dim] - (*point)[dim]) / bandwidth;
+          density += weight * std::exp(-0.5 * z * z) / (bandwidth * std::sqrt(2.0 * std::acos(-1.0)));
+        }
+        total += std::log(density);
+      }
+      return total;
+    }
+
+    private:
+    std::vector<std::vector<double> const*> points;
+    double bandwidth;
+  };
+}
+
+/**
+ * the tree-structured Parzen estimator.
+ *
+ * The observations are split into the best `tpe:gamma` fraction and the rest, and each
+ * worker evaluates the candidate that maximizes the ratio of the density of the best points
+ * to the density of the rest.  Workers propose and record points independently, so a slow
+ * evaluation does not hold up the others.
+ */
+struct tpe_search: public pressio_search_plugin {
+  public:
+    pressio_search_results search(compat::span<const pressio_data *const> const &input_datas,
+                                  std::function<pressio_search_results::output_type(
+                                          pressio_search_results::input_type const &)> compress_fn,
+                                  distributed::queue::StopToken &token) override {
+      pressio_search_results results;
+      if(mode == pressio_search_mode_target && not target) {
+        results.status = 1;
+        results.msg = "tpe requires opt:target in target mode";
+        return results;
+      }
+      auto const search_lower = transform.to_search(lower_bound);
+      auto const search_upper = transform.to_search(upper_bound);
+      if(!pressio_search_transform::is_valid(search_lower) || !pressio_search_transform::is_valid(search_upper)) {
+        results.status = 1;
+        results.msg = "opt:lower_bound and opt:upper_bound must be in the domain of opt:transform";
+        return results;
+      }
+      compress_fn = transform.wrap(std::move(compress_fn));
+      const size_t n_dims = search_lower.size();
+      const auto start_time = std::chrono::system_clock::now();
+      const auto max_time = start_time + std::chrono::seconds(max_seconds);
+      pressio_search_budget budget(time_budget);
+      pressio_search_feasibility feasibility(constraints);
+
+      const pressio_search_objective goal(mode, target, global_rel_tolerance);
+      const pressio_search_unit_cube cube(search_lower, search_upper, is_integral, transform);
+
+      //observations in [0,1]^n_dims and their losses; infeasible observations have an infinite loss
+      std::vector<std::vector<double>> xs;
+      std::vector<double> losses;
+      compat::optional<pressio_search_results::input_type> best_input;
+      pressio_search_results::output_type best_output;
+      try {
+        auto const prior = evaluations_to_history(transform.evaluations_to_search(evaluations_data, n_dims), n_dims);
+        for (auto const& eval : prior) {
+          xs.push_back(cube.to_unit(eval.first));
+          losses.push_back(goal.loss(eval.second));
+          //prior evaluations only contain the objective, so they are only trusted if there are no constraints
+          if(constraints.empty() && (not best_input || losses.back() < goal.loss(best_output))) {
+            best_input = eval.first;
+            best_output = eval.second;
+          }
+        }
+      } catch(std::runtime_error const& err) {
+        results.status = -1;
+        results.msg = err.what();
+        return results;
+      }
+
+      std::mutex mutex;
+      std::mt19937_64 gen(seed.value_or(time(nullptr)));
+      const pressio_search_sequence startup(pressio_search_sequence::kind::sobol,
+          std::min(n_dims, pressio_search_sequence::max_dims(pressio_search_sequence::kind::sobol)),
+          initial_points, gen(), true);
+      size_t startup_index = 0;
+      size_t started = 0;
+      bool done = best_input && goal.is_achieved(best_output.front());
+      bool timed_out = false;
+
+      //must be called with the mutex held
+      auto propose = [&]() {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        if(xs.size() < initial_points) {
+          auto unit = startup.point(startup_index++);
+          while(unit.size() < n_dims) unit.push_back(uniform(gen));
+          return unit;
+        }
+        //split the observations at the gamma quantile of the loss in linear time
+        std::vector<size_t> order(xs.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        const size_t n_good = std::max<size_t>(1, static_cast<size_t>(std::ceil(gamma * static_cast<double>(xs.size()))));
+        std::nth_element(std::begin(order), std::begin(order) + (n_good - 1), std::end(order), [&](size_t lhs, size_t rhs) {
+            return losses[lhs] < losses[rhs];
+        });
+        std::vector<std::vector<double> const*> good, bad;
+        for (size_t i = 0; i < order.size(); ++i) {
+          if(i < n_good && std::isfinite(losses[order[i]])) good.push_back(&xs[order[i]]);
+          else bad.push_back(&xs[order[i]]);
+        }
+        const parzen_estimator l(std::move(good), n_dims);
+        const parzen_estimator g(std::move(bad), n_dims);
+        std::vector<double> best_candidate;
+        double best_score = std::numeric_limits<double>::lowest();
+        for (size_t c = 0; c < std::max(1u, candidates); ++c) {
+          auto candidate = l.sample(gen, n_dims);
+          //snap integral inputs so the densities are evaluated where the point will be evaluated
+          candidate = cube.to_unit(cube.from_unit(candidate));
+          if(feasibility.pruned(cube.from_unit(candidate))) continue;
+          const double score = l.log_density(candidate) - g.log_density(candidate);
+          if(score > best_score) {
+            best_score = score;
+            best_candidate = std::move(candidate);
+          }
+        }
+        if(best_candidate.empty()) {
+          best_candidate.resize(n_dims);
+          for (auto& value : best_candidate) value = uniform(gen);
+        }
+        return best_candidate;
+      };
+      //must be called with the mutex held
+      auto should_stop = [&]() {
+        if(max_seconds > 0 && std::chrono::system_clock::now() > max_time) timed_out = true;
+        if(budget.expired()) timed_out = true;
+        return done || timed_out || started >= max_iterations || token.stop_requested();
+      };
+
+      auto worker = [&]() {
+        while(true) {
+          pressio_search_results::input_type input;
+          {
+            std::lock_guard<std::mutex> guard(mutex);
+            if(should_stop()) return;
+            ++started;
+            input = cube.from_unit(propose());
+          }
+          pressio_search_results::output_type output;
+          if(!feasibility.pruned(input)) {
+            output = compress_fn(input);
+            feasibility.record(input, output);
+          }
+          std::lock_guard<std::mutex> guard(mutex);
+          xs.push_back(cube.to_unit(input));
+          const bool feasible = !output.empty() && constraints.feasible(output);
+          losses.push_back(feasible ? goal.loss(output) : std::numeric_limits<double>::infinity());
+          if(feasible && (not best_input || losses.back() < goal.loss(best_output))) {
+            best_input = input;
+            best_output = output;
+            if(goal.is_achieved(output.front())) {
+              done = true;
+            }
+          }
+        }
+      };
+
+      const size_t n_workers = (thread_safe) ? std::max(1u, nthreads) : 1;
+      if(n_workers > 1) {
+        std::vector<std::exception_ptr> errors(n_workers);
+        std::vector<std::thread> threads;
+        threads.reserve(n_workers);
+        for (size_t i = 0; i < n_workers; ++i) {
+          threads.emplace_back([&, i]() {
+            try {
+              worker();
+            } catch(...) {
+              errors[i] = std::current_exception();
+              std::lock_guard<std::mutex> guard(mutex);
+              done = true;
+            }
+          });
+        }
+        for (auto& thread : threads) {
+          thread.join();
+        }
+        for (auto const& error : errors) {
+          if(error) std::rethrow_exception(error);
+        }
+      } else {
+        worker();
+      }
+
+      const bool achieved = best_input && goal.is_achieved(best_output.front());
+      if(achieved) {
+        token.request_stop();
+      } else if(started >= max_iterations) {
+        results.status = -1;
+        results.msg = "iterations exceeded";
+      } else if(timed_out) {
+        results.status = -2;
+        results.msg = "time-limit exceeded";
+      }
+      if(best_input) {
+        results.inputs = transform.from_search(*best_input);
+        results.output = best_output;
+      } else {
+        results.status = -3;
+        results.msg = "no feasible point found";
+      }
+      return results;
+    }
+
+    //configuration
+    pressio_options get_options() const override {
+      pressio_options opts;
+      set(opts, "opt:lower_bound", pressio_data(std::begin(lower_bound), std::end(lower_bound)));
+      set(opts, "opt:upper_bound", pressio_data(std::begin(upper_bound), std::end(upper_bound)));
+      std::vector<uint8_t> is_integral_u8(is_integral.begin(), is_integral.end());
+      set(opts, "opt:is_integral", pressio_data(std::begin(is_integral_u8), std::end(is_integral_u8)));
+      set(opts, "opt:max_iterations", max_iterations);
+      set(opts, "opt:max_seconds", max_seconds);
+      set(opts, "opt:global_rel_tolerance", global_rel_tolerance);
+      set(opts, "opt:target", target);
+      set(opts, "opt:objective_mode", mode);
+      set(opts, "opt:evaluations", evaluations_data);
+      set(opts, "opt:time_budget", time_budget);
+      set(opts, "opt:constraints", constraints.constraints());
+      set(opts, "opt:constraints_monotone", pressio_data(std::begin(constraints.monotone()), std::end(constraints.monotone())));
+      set(opts, "opt:transform", transform.names());
+      set(opts, "tpe:nthreads", nthreads);
+      set(opts, "tpe:initial_points", initial_points);
+      set(opts, "tpe:candidates", candidates);
+      set(opts, "tpe:gamma", gamma);
+      set(opts, "tpe:seed", seed);
+      return opts;
+    }
+    int set_options(pressio_options const& options) override {
+      pressio_data data;
+      if(get(options, "opt:lower_bound", &data) == pressio_options_key_set) {
+        lower_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:upper_bound", &data) == pressio_options_key_set) {
+        upper_bound = data.to_vector<pressio_search_results::input_element_type>();
+      }
+      if(get(options, "opt:is_integral", &data) == pressio_options_key_set) {
+        auto is_integral_u8 = data.to_vector<uint8_t>();
+        is_integral = std::vector<bool>(is_integral_u8.begin(), is_integral_u8.end());
+      }
+      get(options, "opt:max_iterations", &max_iterations);
+      get(options, "opt:max_seconds", &max_seconds);
+      get(options, "opt:global_rel_tolerance", &global_rel_tolerance);
+      get(options, "opt:target", &target);
+      get(options, "opt:objective_mode", &mode);
+      get(options, "opt:evaluations", &evaluations_data);
+      get(options, "opt:time_budget", &time_budget);
+      get(options, "opt:thread_safe", &thread_safe);
+      get(options, "tpe:nthreads", &nthreads);
+      get(options, "tpe:initial_points", &initial_points);
+      get(options, "tpe:candidates", &candidates);
+      double tmp_gamma;
+      if(get(options, "tpe:gamma", &tmp_gamma) == pressio_options_key_set) {
+        if(!(tmp_gamma > 0 && tmp_gamma < 1)) return set_error(1, "tpe:gamma must be in (0,1)");
+        gamma = tmp_gamma;
+      }
+      get(options, "tpe:seed", &seed);
+      std::string constraints_err;
+      if(constraints.set_options(options, get_name(), constraints_err)) {
+        return set_error(1, constraints_err);
+      }
+      std::string transform_err;
+      if(transform.set_options(options, get_name(), transform_err)) {
+        return set_error(1, transform_err);
+      }
+      return 0;
+    }
+
+    //meta-data
+    /** get the prefix used by this compressor for options */
+    const char* prefix() const override {
+      return "tpe";
+    }
+
+    /** get a version string for the compressor
+     * \see pressio_compressor_version for the semantics this function should obey
+     */
+    const char* version() const override {
+      return "0.0.1";
+    }
+    /** get the major version, default version returns 0
+     * \see pressio_compressor_major_version for the semantics this function should obey
+     */
+    int major_version() const override { return 0; }
+    /** get the minor version, default version returns 0
+     * \see pressio_compressor_minor_version for the semantics this function should obey
+     */
+    int minor_version() const override { return 0; }
+    /** get the patch version, default version returns 0
+     * \see pressio_compressor_patch_version for the semantics this function should obey
+     */
+    int patch_version() const override { return 1; }
+
+    std::shared_ptr<pressio_search_plugin> clone() override {
+      return compat::make_unique<tpe_search>(*this);
+    }
+
+private:
+    pressio_search_results::input_type lower_bound{};
+    pressio_search_results::input_type upper_bound{};
+    std::vector<bool> is_integral{};
+    compat::optional<pressio_search_results::output_type::value_type> target{};
+    pressio_data evaluations_data;
+    pressio_search_constraints constraints;
+    pressio_search_transform transform;
+    double global_rel_tolerance = .1;
+    unsigned int max_iterations = 100;
+    unsigned int max_seconds = 0;
+    double time_budget = std::numeric_limits<double>::max();
+    unsigned int mode = pressio_search_mode_target;
+    unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int initial_points = 10;
+    unsigned int candidates = 24;
+    double gamma = .25;
+    compat::optional<unsigned int> seed;
+    int thread_safe = 0;
+};
+
+
+static pressio_register tpe_register(search_plugins(), "tpe", [](){ return compat::make_unique<tpe_search>();});
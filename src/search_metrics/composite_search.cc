@@ -27,6 +27,12 @@ struct composite_search_metrics : public pressio_search_metrics_plugin {
     }
   }
 
+  void screened_iter(pressio_search_results::input_type const& input, pressio_search_results::output_type const& predicted) override {
+    for (auto& plugin : plugins) {
+      plugin->screened_iter(input, predicted);
+    }
+  }
+
   void end_search(pressio_search_results::input_type const& input, pressio_search_results::output_type const& out) override {
     for (auto& plugin : plugins) {
       plugin->end_search(input, out);
@@ -0,0 +1,132 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include <libpressio_ext/cpp/libpressio.h>
+#include <sz.h>
+#include "gtest/gtest.h"
+#include "pressio_search_defines.h"
+
+namespace {
+pressio_data make_data(double scale) {
+  const size_t n = 32;
+  auto data = pressio_data::owning(pressio_float_dtype, {n, n, n});
+  auto values = static_cast<float*>(data.data());
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      for (size_t k = 0; k < n; ++k) {
+        *values++ = static_cast<float>(scale * (std::sin(i * .2) * std::cos(j * .3) + k * .01));
+      }
+    }
+  }
+  return data;
+}
+
+pressio_options sz_options(std::string const& search) {
+  pressio_options options;
+  options.set("opt:compressor", "sz");
+  options.set("opt:search", search);
+  options.set("opt:inputs", std::vector<std::string>{"sz:rel_err_bound"});
+  options.set("opt:output", std::vector<std::string>{"size:compression_ratio"});
+  options.set("opt:lower_bound", pressio_data{1e-6});
+  options.set("opt:upper_bound", pressio_data{1e-1});
+  options.set("opt:objective_mode_name", "target");
+  options.set("opt:global_rel_tolerance", .05);
+  options.set("opt:max_iterations", 30u);
+  options.set("sz:error_bound_mode", REL);
+  options.set("sz:metric", "size");
+  return options;
+}
+
+pressio_compressor make_opt(pressio& library, pressio_options const& options) {
+  auto compressor = library.get_compressor("opt");
+  if(!compressor) throw std::runtime_error(library.err_msg());
+  if(compressor->set_options(options)) throw std::runtime_error(compressor->error_msg());
+  return compressor;
+}
+
+/** compresses data and returns the metrics of the search */
+pressio_options compress(pressio_compressor& compressor, pressio_data const& data) {
+  pressio_data compressed = pressio_data::empty(pressio_byte_dtype, {});
+  compressor->compress(&data, &compressed);
+  return compressor->get_metrics_results();
+}
+
+template <class T>
+T get_metric(pressio_compressor const& compressor, pressio_options const& metrics, std::string const& key) {
+  T value{};
+  EXPECT_EQ(metrics.get(compressor->get_name(), key, &value), pressio_options_key_set) << key;
+  return value;
+}
+}
+
+TEST(pressio_opt, multiple_targets_restore_the_bounds) {
+  pressio library;
+  auto const data = make_data(1.0);
+  auto single_target = sz_options("binary");
+  single_target.set("opt:target", 12.0);
+
+  auto fresh = make_opt(library, single_target);
+  auto const expected = compress(fresh, data);
+
+  auto multi_target = sz_options("binary");
+  multi_target.set("opt:target", pressio_data{8.0, 16.0});
+  auto reused = make_opt(library, multi_target);
+  compress(reused, data);
+  //only the target changes, so the brackets used for each target must not narrow the next search
+  pressio_options retarget;
+  retarget.set("opt:target", 12.0);
+  ASSERT_EQ(reused->set_options(retarget), 0) << reused->error_msg();
+  auto const actual = compress(reused, data);
+
+  EXPECT_EQ(get_metric<int>(reused, actual, "opt:status"), get_metric<int>(fresh, expected, "opt:status"));
+  EXPECT_EQ(get_metric<pressio_data>(reused, actual, "opt:input").to_vector<double>(),
+            get_metric<pressio_data>(fresh, expected, "opt:input").to_vector<double>());
+}
+
+TEST(pressio_opt, warm_starts_evaluate_the_new_data) {
+  pressio library;
+  auto options = sz_options("fraz");
+  options.set("opt:target", 10.0);
+  options.set("opt:warm_start", 1);
+  options.set("opt:warm_start_path", std::string());
+  auto compressor = make_opt(library, options);
+
+  compress(compressor, make_data(1.0));
+  auto const data = make_data(1.1);
+  auto const metrics = compress(compressor, data);
+  EXPECT_EQ(get_metric<uint64_t>(compressor, metrics, "opt:warm_start_neighbors"), 1);
+  //the best point of the past search is evaluated again on this data
+  EXPECT_EQ(get_metric<uint64_t>(compressor, metrics, "opt:warm_start_evaluations"), 1);
+
+  //a past search that met the target on other data must not be reported as the answer for this data
+  auto const input = get_metric<pressio_data>(compressor, metrics, "opt:input").to_vector<double>();
+  auto const output = get_metric<pressio_data>(compressor, metrics, "opt:output").to_vector<double>();
+  ASSERT_EQ(input.size(), 1);
+  ASSERT_FALSE(output.empty());
+
+  auto sz = library.get_compressor("sz");
+  ASSERT_TRUE(sz);
+  pressio_options sz_settings;
+  sz_settings.set("sz:error_bound_mode", REL);
+  sz_settings.set("sz:rel_err_bound", input.front());
+  sz_settings.set("sz:metric", "size");
+  ASSERT_EQ(sz->set_options(sz_settings), 0) << sz->error_msg();
+  pressio_data compressed = pressio_data::empty(pressio_byte_dtype, {});
+  ASSERT_EQ(sz->compress(&data, &compressed), 0) << sz->error_msg();
+  double compression_ratio = 0;
+  ASSERT_EQ(sz->get_metrics_results().get(sz->get_name(), "size:compression_ratio", &compression_ratio), pressio_options_key_set);
+  EXPECT_DOUBLE_EQ(output.front(), compression_ratio);
+}
+
+TEST(pressio_opt, inputs_must_exist_in_a_candidate) {
+  pressio library;
+  auto options = sz_options("binary");
+  options.set("opt:compressors", std::vector<std::string>{"sz"});
+  options.set("opt:inputs", std::vector<std::string>{"sz:rel_err_bnd"});
+  auto compressor = library.get_compressor("opt");
+  ASSERT_TRUE(compressor);
+  EXPECT_NE(compressor->set_options(options), 0);
+
+  options.set("opt:inputs", std::vector<std::string>{"sz:rel_err_bound"});
+  EXPECT_EQ(compressor->set_options(options), 0) << compressor->error_msg();
+}
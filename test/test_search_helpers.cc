@@ -0,0 +1,350 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <mpi.h>
+#include "gtest/gtest.h"
+#include "pressio_search_constraints.h"
+#include "pressio_search_evaluations.h"
+#include "pressio_search_objective.h"
+#include "pressio_search_sequence.h"
+#include "pressio_search_transform.h"
+#include "pressio_search_warm_start.h"
+
+namespace {
+struct test_stop_token: public distributed::queue::StopToken {
+  bool stop_requested() override { return should_stop; }
+  void request_stop() override { should_stop = true; }
+  bool should_stop = false;
+};
+
+pressio_search_constraints make_constraints(std::vector<std::string> const& outputs, std::vector<std::string> const& constraints) {
+  pressio_options options;
+  options.set("opt:output", outputs);
+  options.set("opt:constraints", constraints);
+  pressio_search_constraints parsed;
+  std::string err;
+  if(parsed.set_options(options, "", err)) throw std::runtime_error(err);
+  return parsed;
+}
+}
+
+TEST(pressio_search_cache, answers_repeated_points_from_the_cache) {
+  int calls = 0;
+  pressio_search_cache cache([&calls](pressio_search_results::input_type const& input) {
+      ++calls;
+      return pressio_search_results::output_type{input.front() * 2};
+  });
+  EXPECT_EQ(cache({1.0}), pressio_search_results::output_type{2.0});
+  EXPECT_EQ(cache({1.0}), pressio_search_results::output_type{2.0});
+  EXPECT_EQ(cache({2.0}), pressio_search_results::output_type{4.0});
+  EXPECT_EQ(calls, 2);
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 2);
+  EXPECT_EQ(cache.history().size(), 2);
+  EXPECT_FALSE(cache.find({3.0}));
+}
+
+TEST(pressio_search_cache, failed_evaluations_are_retried) {
+  int calls = 0;
+  pressio_search_cache cache([&calls](pressio_search_results::input_type const& input) {
+      if(++calls == 1) throw std::runtime_error("failed");
+      return pressio_search_results::output_type{input.front()};
+  });
+  EXPECT_THROW(cache({1.0}), std::runtime_error);
+  EXPECT_TRUE(cache.history().empty());
+  EXPECT_EQ(cache({1.0}), pressio_search_results::output_type{1.0});
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(pressio_search_cache, tolerance_reports_the_evaluated_point) {
+  int calls = 0;
+  pressio_search_cache cache([&calls](pressio_search_results::input_type const& input) {
+      ++calls;
+      return pressio_search_results::output_type{input.front() * input.front()};
+  }, {0.0}, {10.0}, 0.1);
+  const auto first = cache({2.1});
+  //2.9 is in the same cell as 2.1 so it is answered with the outputs of 2.1
+  EXPECT_EQ(cache({2.9}), first);
+  EXPECT_EQ(calls, 1);
+
+  auto evaluation = cache.find_evaluation({2.9});
+  ASSERT_TRUE(evaluation);
+  EXPECT_EQ(evaluation->first, pressio_search_results::input_type{2.1});
+  EXPECT_EQ(evaluation->second, first);
+
+  //inserted evaluations do not replace the evaluation already in a cell
+  cache.insert({2.5}, {100.0});
+  EXPECT_EQ(cache.find_evaluation({2.5})->first, pressio_search_results::input_type{2.1});
+  EXPECT_EQ(cache({3.1}), pressio_search_results::output_type{3.1 * 3.1});
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(pressio_search_evaluations, history_round_trips) {
+  pressio_search_history history{{{1.0, 2.0}, {3.0, 4.0}}, {{5.0, 6.0}, {7.0}}};
+  auto data = history_to_evaluations(history, 2);
+  ASSERT_EQ(data.num_dimensions(), 2);
+  EXPECT_EQ(data.get_dimension(0), 3);
+  EXPECT_EQ(data.get_dimension(1), 2);
+  auto restored = evaluations_to_history(data, 2);
+  EXPECT_EQ(restored.size(), 2);
+  EXPECT_EQ(restored[pressio_search_results::input_type({1.0, 2.0})], pressio_search_results::output_type{3.0});
+  EXPECT_EQ(restored[pressio_search_results::input_type({5.0, 6.0})], pressio_search_results::output_type{7.0});
+  EXPECT_THROW(evaluations_to_history(data, 3), std::runtime_error);
+}
+
+TEST(pressio_search_evaluations, seeds_are_within_bounds_and_replace_priors) {
+  pressio_data prior = history_to_evaluations({{{1.0}, {99.0}}, {{4.0}, {4.0}}}, 1);
+  pressio_search_history history{{{1.0}, {1.0}}, {{2.0}, {2.0}}, {{8.0}, {8.0}}};
+  auto seeds = evaluations_to_history(seed_evaluations(history, pressio_search_constraints(), 1, prior, {0.0}, {5.0}), 1);
+  EXPECT_EQ(seeds, pressio_search_history({{{1.0}, {1.0}}, {{2.0}, {2.0}}, {{4.0}, {4.0}}}));
+}
+
+TEST(pressio_search_evaluations, seeds_drop_infeasible_and_failed_evaluations) {
+  auto constraints = make_constraints({"objective", "quality"}, {"quality >= 1"});
+  pressio_data prior = history_to_evaluations({{{3.0}, {3.0}}}, 1);
+  pressio_search_history history{{{1.0}, {1.0, 2.0}}, {{2.0}, {2.0, 0.0}}, {{3.0}, {3.0, 0.0}}, {{4.0}, {}}};
+  auto seeds = evaluations_to_history(seed_evaluations(history, constraints, 1, prior), 1);
+  EXPECT_EQ(seeds, pressio_search_history({{{1.0}, {1.0}}}));
+}
+
+TEST(pressio_search_sequence, halton_is_the_radical_inverse) {
+  pressio_search_sequence sequence(pressio_search_sequence::kind::halton, 2, 8, 0, false);
+  EXPECT_DOUBLE_EQ(sequence.point(0)[0], 1.0/2.0);
+  EXPECT_DOUBLE_EQ(sequence.point(0)[1], 1.0/3.0);
+  EXPECT_DOUBLE_EQ(sequence.point(1)[0], 1.0/4.0);
+  EXPECT_DOUBLE_EQ(sequence.point(1)[1], 2.0/3.0);
+  EXPECT_DOUBLE_EQ(sequence.point(2)[1], 1.0/9.0);
+}
+
+TEST(pressio_search_sequence, lhs_has_one_point_per_stratum) {
+  const size_t n_points = 10, n_dims = 3;
+  pressio_search_sequence sequence(pressio_search_sequence::kind::lhs, n_dims, n_points, 42, true);
+  std::vector<std::set<int>> strata(n_dims);
+  for (size_t i = 0; i < n_points; ++i) {
+    auto const point = sequence.point(i);
+    for (size_t dim = 0; dim < n_dims; ++dim) {
+      EXPECT_GE(point[dim], 0.0);
+      EXPECT_LT(point[dim], 1.0);
+      strata[dim].insert(static_cast<int>(point[dim] * n_points));
+    }
+  }
+  for (auto const& stratum : strata) {
+    EXPECT_EQ(stratum.size(), n_points);
+  }
+}
+
+TEST(pressio_search_sequence, seeds_are_reproducible) {
+  for (auto const& name : {"uniform", "sobol", "halton", "lhs"}) {
+    pressio_search_sequence::kind kind;
+    ASSERT_EQ(pressio_search_sequence::parse(name, kind), 0) << name;
+    pressio_search_sequence first(kind, 4, 16, 7, true), second(kind, 4, 16, 7, true);
+    for (uint64_t i = 0; i < 16; ++i) {
+      EXPECT_EQ(first.point(i), second.point(i)) << name;
+    }
+  }
+  pressio_search_sequence::kind kind;
+  EXPECT_NE(pressio_search_sequence::parse("unknown", kind), 0);
+}
+
+TEST(pressio_search_transform, round_trips_each_kind) {
+  pressio_options options;
+  options.set("opt:transform", std::vector<std::string>{"linear", "log10", "logit"});
+  pressio_search_transform transform;
+  std::string err;
+  ASSERT_EQ(transform.set_options(options, "", err), 0) << err;
+  EXPECT_FALSE(transform.is_linear());
+  EXPECT_TRUE(transform.is_linear(0));
+  EXPECT_FALSE(transform.is_linear(1));
+
+  pressio_search_results::input_type const input{-3.0, 1e-4, 0.25};
+  auto const search = transform.to_search(input);
+  EXPECT_DOUBLE_EQ(search[0], -3.0);
+  EXPECT_DOUBLE_EQ(search[1], -4.0);
+  EXPECT_DOUBLE_EQ(search[2], std::log(0.25 / 0.75));
+  auto const restored = transform.from_search(search);
+  for (size_t dim = 0; dim < input.size(); ++dim) {
+    EXPECT_NEAR(restored[dim], input[dim], 1e-12 * std::abs(input[dim]));
+  }
+
+  EXPECT_FALSE(pressio_search_transform::is_valid(transform.to_search({0.0, -1.0, 0.5})));
+  options.set("opt:transform", std::vector<std::string>{"sqrt"});
+  EXPECT_NE(transform.set_options(options, "", err), 0);
+}
+
+TEST(pressio_search_objective, loss_and_achievement_follow_the_mode) {
+  pressio_search_objective min(pressio_search_mode_min, 1.0, 0.0);
+  EXPECT_LT(min.loss(0.5), min.loss(2.0));
+  EXPECT_TRUE(min.is_achieved(0.5));
+  EXPECT_FALSE(min.is_achieved(1.5));
+
+  pressio_search_objective max(pressio_search_mode_max, 1.0, 0.0);
+  EXPECT_LT(max.loss(2.0), max.loss(0.5));
+  EXPECT_TRUE(max.is_achieved(1.5));
+
+  pressio_search_objective target(pressio_search_mode_target, 10.0, 0.1);
+  EXPECT_DOUBLE_EQ(target.loss(12.0), 2.0);
+  EXPECT_DOUBLE_EQ(target.loss(8.0), 2.0);
+  EXPECT_TRUE(target.is_achieved(10.5));
+  EXPECT_FALSE(target.is_achieved(11.5));
+
+  pressio_search_objective no_target(pressio_search_mode_target, compat::optional<double>(), 0.1);
+  EXPECT_LT(no_target.loss(1.0), no_target.loss(2.0));
+  EXPECT_FALSE(no_target.is_achieved(1.0));
+}
+
+TEST(pressio_search_objective, unit_cube_rounds_integral_inputs) {
+  pressio_search_unit_cube cube({0.0, 0.0}, {10.0, 10.0}, {false, true}, pressio_search_transform());
+  EXPECT_FALSE(cube.is_integral(0));
+  EXPECT_TRUE(cube.is_integral(1));
+  EXPECT_EQ(cube.from_unit({0.25, 0.26}), pressio_search_results::input_type({2.5, 3.0}));
+  EXPECT_EQ(cube.from_unit({-1.0, 2.0}), pressio_search_results::input_type({0.0, 10.0}));
+  EXPECT_EQ(cube.to_unit({2.5, 20.0}), std::vector<double>({0.25, 1.0}));
+  EXPECT_DOUBLE_EQ(cube.min_step(0, 1e-3), 1e-3);
+  EXPECT_DOUBLE_EQ(cube.min_step(1, 1e-3), 0.1);
+}
+
+TEST(pressio_search_objective, incumbent_keeps_the_best_feasible_evaluation) {
+  test_stop_token token;
+  auto constraints = make_constraints({"objective", "quality"}, {"quality >= 0"});
+  int calls = 0;
+  pressio_search_incumbent incumbent([&calls](pressio_search_results::input_type const& input) {
+        ++calls;
+        //the minimum at 0 is infeasible
+        return pressio_search_results::output_type{input.front() * input.front(), input.front() - 0.2};
+      },
+      pressio_search_objective(pressio_search_mode_min, compat::optional<double>(), 0.0),
+      constraints, pressio_search_unit_cube({-1.0}, {1.0}, {}, pressio_search_transform()),
+      {}, 10, 0, pressio_search_budget(), token);
+  double value;
+  ASSERT_TRUE(incumbent.evaluate({0.5}, value));
+  EXPECT_TRUE(std::isinf(value));
+  ASSERT_TRUE(incumbent.evaluate({0.75}, value));
+  EXPECT_DOUBLE_EQ(value, 0.25);
+  ASSERT_TRUE(incumbent.evaluate({0.75}, value));
+  EXPECT_EQ(calls, 2);
+
+  auto const results = incumbent.results(pressio_search_transform());
+  EXPECT_EQ(results.inputs, pressio_search_results::input_type{0.5});
+  EXPECT_DOUBLE_EQ(results.output.front(), 0.25);
+}
+
+TEST(pressio_search_objective, incumbent_merges_concurrent_requests) {
+  test_stop_token token;
+  pressio_search_constraints constraints;
+  std::atomic<int> calls{0};
+  pressio_search_incumbent incumbent([&calls](pressio_search_results::input_type const& input) {
+        ++calls;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return pressio_search_results::output_type{input.front()};
+      },
+      pressio_search_objective(pressio_search_mode_min, compat::optional<double>(), 0.0),
+      constraints, pressio_search_unit_cube({0.0}, {1.0}, {}, pressio_search_transform()),
+      {}, 10, 0, pressio_search_budget(), token);
+  pressio_search_run_workers(4, [&incumbent]() {
+      double value;
+      EXPECT_TRUE(incumbent.evaluate({0.5}, value));
+      EXPECT_DOUBLE_EQ(value, 0.5);
+  }, []() {});
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(pressio_search_objective, workers_rethrow_the_first_error) {
+  std::atomic<int> runs{0}, stops{0};
+  EXPECT_THROW(pressio_search_run_workers(4, [&runs]() {
+        if(runs++ == 0) throw std::runtime_error("failed");
+      }, [&stops]() { ++stops; }), std::runtime_error);
+  EXPECT_EQ(runs, 4);
+  EXPECT_EQ(stops, 1);
+  EXPECT_NO_THROW(pressio_search_run_workers(1, [&runs]() { ++runs; }, []() {}));
+  EXPECT_EQ(runs, 5);
+}
+
+TEST(pressio_search_warm_start, features_match_identical_data) {
+  std::vector<double> values(1000);
+  for (size_t i = 0; i < values.size(); ++i) values[i] = std::sin(i * .01);
+  pressio_data lhs(std::begin(values), std::end(values)), rhs(std::begin(values), std::end(values));
+  std::vector<float> values_f(std::begin(values), std::end(values));
+  pressio_data other_dtype(std::begin(values_f), std::end(values_f));
+  const pressio_data* lhs_ptr[] = {&lhs};
+  const pressio_data* rhs_ptr[] = {&rhs};
+  const pressio_data* other_ptr[] = {&other_dtype};
+  auto const lhs_features = pressio_search_features::compute(compat::span<const pressio_data* const>(lhs_ptr, 1));
+  auto const rhs_features = pressio_search_features::compute(compat::span<const pressio_data* const>(rhs_ptr, 1));
+  auto const other_features = pressio_search_features::compute(compat::span<const pressio_data* const>(other_ptr, 1));
+  EXPECT_EQ(lhs_features.key, rhs_features.key);
+  EXPECT_NE(lhs_features.key, other_features.key);
+  EXPECT_EQ(lhs_features.values.size(), pressio_search_features::width);
+  EXPECT_DOUBLE_EQ(pressio_search_features::distance(lhs_features.values, rhs_features.values), 0.0);
+}
+
+TEST(pressio_search_warm_start, nearest_searches_come_first) {
+  //features are the log10 size, minimum, maximum, and entropy of each input
+  auto features = [](double log_size) { return std::vector<double>{log_size, 0.0, 1.0, 4.0}; };
+  pressio_search_warm_start library("");
+  std::string err;
+  library.add({"key", features(0.0), {{{1.0}, {1.0, 5.0}}}}, err);
+  library.add({"key", features(2.0), {{{2.0}, {2.0}}}}, err);
+  library.add({"key", features(1.0), {{{3.0}, {3.0}}}}, err);
+  library.add({"other", features(1.9), {{{4.0}, {4.0}}}}, err);
+  auto const nearest = library.nearest("key", features(1.9), 2);
+  ASSERT_EQ(nearest.size(), 2);
+  EXPECT_EQ(nearest[0].features, features(2.0));
+  EXPECT_EQ(nearest[1].features, features(1.0));
+  //only the objective is kept
+  auto const first = library.nearest("key", features(0.0), 1);
+  ASSERT_EQ(first.size(), 1);
+  EXPECT_EQ(first[0].history.begin()->second, pressio_search_results::output_type{1.0});
+}
+
+TEST(pressio_search_warm_start, entries_per_key_are_capped) {
+  pressio_search_warm_start library("");
+  std::string err;
+  const size_t n_entries = pressio_search_warm_start::max_entries_per_key + 8;
+  for (size_t i = 0; i < n_entries; ++i) {
+    library.add({"key", {static_cast<double>(i)}, {{{1.0}, {1.0}}}}, err);
+  }
+  library.add({"other", {0.0}, {{{1.0}, {1.0}}}}, err);
+  auto const entries = library.nearest("key", {0.0}, n_entries);
+  ASSERT_EQ(entries.size(), pressio_search_warm_start::max_entries_per_key);
+  //the oldest were dropped
+  EXPECT_EQ(entries.front().features, std::vector<double>{8.0});
+  EXPECT_EQ(library.nearest("other", {0.0}, n_entries).size(), 1);
+}
+
+TEST(pressio_search_warm_start, libraries_round_trip_through_files) {
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  //only rank 0 saves libraries
+  if(rank != 0) return;
+  const std::string path = "test_search_helpers_warm_start.txt";
+  std::remove(path.c_str());
+  {
+    pressio_search_warm_start library(path);
+    std::string err;
+    ASSERT_EQ(library.add({"key", {1.0, 2.0}, {{{1.0, 2.0}, {3.0}}, {{4.0, 5.0}, {6.0}}}}, err), 0) << err;
+  }
+  pressio_search_warm_start loaded(path);
+  auto const entries = loaded.nearest("key", {1.0, 2.0}, 1);
+  ASSERT_EQ(entries.size(), 1);
+  EXPECT_EQ(entries[0].features, std::vector<double>({1.0, 2.0}));
+  EXPECT_EQ(entries[0].history, pressio_search_history({{{1.0, 2.0}, {3.0}}, {{4.0, 5.0}, {6.0}}}));
+  std::remove(path.c_str());
+}
+
+TEST(pressio_search_warm_start, failed_saves_are_reported) {
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if(rank != 0) return;
+  pressio_search_warm_start library("test_search_helpers_missing_dir/warm_start.txt");
+  std::string err;
+  EXPECT_NE(library.add({"key", {1.0}, {{{1.0}, {1.0}}}}, err), 0);
+  EXPECT_FALSE(err.empty());
+  //the search is still recorded in memory
+  EXPECT_EQ(library.nearest("key", {1.0}, 1).size(), 1);
+}
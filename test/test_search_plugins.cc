@@ -0,0 +1,197 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "pressio_search.h"
+#include "pressio_search_defines.h"
+#include "pressio_search_evaluations.h"
+
+namespace {
+struct test_stop_token: public distributed::queue::StopToken {
+  bool stop_requested() override { return should_stop; }
+  void request_stop() override { should_stop = true; }
+  bool should_stop = false;
+};
+
+using compress_fn_t = std::function<pressio_search_results::output_type(pressio_search_results::input_type const&)>;
+
+pressio_search_results run_search(pressio_search& search, compress_fn_t compress_fn) {
+  test_stop_token token;
+  return search->search({}, std::move(compress_fn), token);
+}
+
+pressio_search build_search(std::string const& id, pressio_options const& options) {
+  pressio_search search = search_plugins().build(id);
+  if(!search) throw std::runtime_error("search is not registered: " + id);
+  if(search->set_options(options)) throw std::runtime_error(search->error_msg());
+  return search;
+}
+
+/** a 1-D objective that increases monotonically on [0, 10] with the steepness of power */
+compress_fn_t monotone(double power, int& calls) {
+  return [power, &calls](pressio_search_results::input_type const& input) {
+    ++calls;
+    return pressio_search_results::output_type{100.0 * std::pow(input.front() / 10.0, power)};
+  };
+}
+
+/** a separable quadratic on [-5, 5]^3 with its minimum of 0 at {1, -2, .5} */
+pressio_search_results::output_type separable_quadratic(pressio_search_results::input_type const& input) {
+  const double center[] = {1.0, -2.0, .5};
+  double value = 0;
+  for (size_t dim = 0; dim < input.size(); ++dim) {
+    value += (input[dim] - center[dim]) * (input[dim] - center[dim]);
+  }
+  return {value};
+}
+
+pressio_options target_options(double target) {
+  pressio_options options;
+  options.set("opt:lower_bound", pressio_data{0.0});
+  options.set("opt:upper_bound", pressio_data{10.0});
+  options.set("opt:target", target);
+  options.set("opt:objective_mode", static_cast<unsigned int>(pressio_search_mode_target));
+  options.set("opt:global_rel_tolerance", 1e-6);
+  options.set("opt:max_iterations", 200u);
+  return options;
+}
+
+pressio_options min_options() {
+  pressio_options options;
+  options.set("opt:lower_bound", pressio_data{-5.0, -5.0, -5.0});
+  options.set("opt:upper_bound", pressio_data{5.0, 5.0, 5.0});
+  options.set("opt:target", 1e-4);
+  options.set("opt:objective_mode", static_cast<unsigned int>(pressio_search_mode_min));
+  options.set("opt:max_iterations", 2000u);
+  return options;
+}
+}
+
+class monotone_target_search: public ::testing::TestWithParam<std::string> {};
+
+TEST_P(monotone_target_search, reaches_targets_of_monotone_objectives) {
+  for (double power : {1.0, 3.0, 7.0}) {
+    for (double target : {0.5, 2.0, 10.0, 50.0, 90.0}) {
+      auto search = build_search(GetParam(), target_options(target));
+      int calls = 0;
+      auto const results = run_search(search, monotone(power, calls));
+      //monotone objectives were reported as non-monotonic by secant when one end of the bracket moved
+      EXPECT_EQ(results.status, 0) << "power " << power << " target " << target << ": " << results.msg;
+      ASSERT_EQ(results.output.size(), 1);
+      EXPECT_NEAR(results.output.front(), target, target * 1e-6);
+      EXPECT_LE(calls, 200);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(pressio_search, monotone_target_search, ::testing::Values("secant", "binary", "kary"));
+
+class separable_min_search: public ::testing::TestWithParam<std::string> {};
+
+TEST_P(separable_min_search, minimizes_a_separable_quadratic) {
+  auto search = build_search(GetParam(), min_options());
+  auto const results = run_search(search, separable_quadratic);
+  EXPECT_EQ(results.status, 0) << results.msg;
+  ASSERT_EQ(results.inputs.size(), 3);
+  ASSERT_EQ(results.output.size(), 1);
+  EXPECT_LT(results.output.front(), 1e-4);
+  EXPECT_EQ(separable_quadratic(results.inputs), results.output);
+}
+
+INSTANTIATE_TEST_SUITE_P(pressio_search, separable_min_search, ::testing::Values("coordinate", "multistart", "cmaes"));
+
+TEST(pressio_search_bo, tolerates_duplicate_points) {
+  //an integral input with 4 values must be evaluated again and again within the budget
+  pressio_options options;
+  std::vector<uint8_t> is_integral{1};
+  options.set("opt:lower_bound", pressio_data{0.0});
+  options.set("opt:upper_bound", pressio_data{3.0});
+  options.set("opt:is_integral", pressio_data(std::begin(is_integral), std::end(is_integral)));
+  options.set("opt:objective_mode", static_cast<unsigned int>(pressio_search_mode_min));
+  options.set("opt:max_iterations", 30u);
+  auto search = build_search("bo", options);
+  auto const results = run_search(search, [](pressio_search_results::input_type const& input) {
+      return pressio_search_results::output_type{(input.front() - 2.0) * (input.front() - 2.0)};
+  });
+  EXPECT_EQ(results.status, -1) << results.msg;
+  EXPECT_EQ(results.inputs, pressio_search_results::input_type{2.0});
+  EXPECT_EQ(results.output, pressio_search_results::output_type{0.0});
+}
+
+TEST(pressio_search_guess_first, infeasible_guess_does_not_end_the_search) {
+  //the guess meets the target but violates the constraint, so the nested search must
+  //find the feasible point that meets the target instead of accepting the guess
+  pressio_options options;
+  options.set("guess_first:search", "fraz");
+  options.set("opt:prediction", pressio_data{8.0});
+  options.set("opt:lower_bound", pressio_data{0.0});
+  options.set("opt:upper_bound", pressio_data{10.0});
+  options.set("opt:target", 3.0);
+  options.set("opt:objective_mode", static_cast<unsigned int>(pressio_search_mode_target));
+  options.set("opt:global_rel_tolerance", .01);
+  options.set("opt:max_iterations", 100u);
+  options.set("opt:output", std::vector<std::string>{"objective", "input"});
+  options.set("opt:constraints", std::vector<std::string>{"input <= 5"});
+  auto search = build_search("guess_first", options);
+  auto const results = run_search(search, [](pressio_search_results::input_type const& input) {
+      return pressio_search_results::output_type{std::abs(input.front() - 5.0), input.front()};
+  });
+  EXPECT_EQ(results.status, 0) << results.msg;
+  ASSERT_EQ(results.inputs.size(), 1);
+  EXPECT_LE(results.inputs.front(), 5.0);
+  EXPECT_NEAR(results.output.front(), 3.0, .03);
+}
+
+TEST(pressio_search_fraz, priors_are_feasible) {
+  //priors only carry the objective, so a constraint on another output cannot be checked against them
+  pressio_options options;
+  options.set("opt:lower_bound", pressio_data{0.0});
+  options.set("opt:upper_bound", pressio_data{10.0});
+  options.set("opt:target", 3.0);
+  options.set("opt:objective_mode", static_cast<unsigned int>(pressio_search_mode_target));
+  options.set("opt:global_rel_tolerance", .01);
+  options.set("opt:max_iterations", 10u);
+  options.set("opt:output", std::vector<std::string>{"objective", "input"});
+  options.set("opt:constraints", std::vector<std::string>{"input <= 5"});
+  options.set("opt:evaluations", history_to_evaluations({{{3.0}, {3.0}}}, 1));
+  auto search = build_search("fraz", options);
+  int calls = 0;
+  auto const results = run_search(search, [&calls](pressio_search_results::input_type const& input) {
+      ++calls;
+      return pressio_search_results::output_type{input.front(), input.front()};
+  });
+  EXPECT_EQ(results.status, 0) << results.msg;
+  EXPECT_EQ(results.inputs, pressio_search_results::input_type{3.0});
+  EXPECT_EQ(results.output, pressio_search_results::output_type{3.0});
+  EXPECT_EQ(calls, 0);
+}
+
+TEST(pressio_search_kary, counts_evaluations_not_rounds) {
+  auto options = target_options(42.0);
+  options.set("opt:thread_safe", 1);
+  options.set("kary:nthreads", 4u);
+  options.set("opt:max_iterations", 6u);
+  auto search = build_search("kary", options);
+  int calls = 0;
+  auto const results = run_search(search, monotone(1.0, calls));
+  //the second round only has the two evaluations that remain
+  EXPECT_EQ(calls, 6);
+  EXPECT_EQ(results.status, -1) << results.msg;
+}
+
+TEST(pressio_search_portfolio, children_keep_their_options) {
+  auto options = target_options(42.0);
+  options.set("portfolio:search", std::vector<std::string>{"binary", "secant"});
+  options.set("opt:time_budget", 60.0);
+  pressio_search search = search_plugins().build("portfolio");
+  ASSERT_TRUE(search);
+  search->set_name("portfolio");
+  ASSERT_EQ(search->set_options(options), 0) << search->error_msg();
+  int calls = 0;
+  auto const results = run_search(search, monotone(1.0, calls));
+  EXPECT_EQ(results.status, 0) << results.msg;
+  //the share of the budget each child was given only applies to this search
+  double child_budget = 0;
+  ASSERT_EQ(search->get_options().get("portfolio/secant", "opt:time_budget", &child_budget), pressio_options_key_set);
+  EXPECT_EQ(child_budget, 60.0);
+}